@@ -0,0 +1,54 @@
+# bake_vector_asset(TARGET_NAME [FACTORS F1 F2 ...] ASSETS asset1.svg asset2.svg ...)
+#
+# Converts every SVG asset to a BinaryScene next to its copy in the build tree
+# (assets/foo.svg -> assets/foo.vgs) with vgbake, its meshes tessellated for
+# each of FACTORS (VECTOR_GRAPHIC_BAKE_FACTORS by default). The scenes are
+# rebuilt when the SVG file or vgbake changes.
+#
+# vgbake runs on the host: when cross compiling (e.g. Emscripten), point
+# VGBAKE_EXECUTABLE at the one of a native build. Without it the assets are
+# left to be parsed at runtime.
+set(VECTOR_GRAPHIC_BAKE_FACTORS 25 100 400 CACHE STRING "Tesselation factors the vector assets are baked for")
+set(VGBAKE_EXECUTABLE "" CACHE FILEPATH "Host vgbake, to bake the vector assets when cross compiling")
+
+function(bake_vector_asset TARGET_NAME)
+    cmake_parse_arguments(BAKE "" "" "FACTORS;ASSETS" ${ARGN})
+    if(NOT BAKE_FACTORS)
+        set(BAKE_FACTORS ${VECTOR_GRAPHIC_BAKE_FACTORS})
+    endif()
+    string(REPLACE ";" "," BAKE_FACTORS "${BAKE_FACTORS}")
+
+    if(TARGET vgbake)
+        set(VGBAKE $<TARGET_FILE:vgbake>)
+        set(VGBAKE_DEPENDENCY vgbake)
+    elseif(VGBAKE_EXECUTABLE)
+        set(VGBAKE ${VGBAKE_EXECUTABLE})
+        set(VGBAKE_DEPENDENCY ${VGBAKE_EXECUTABLE})
+    else()
+        message(STATUS "${TARGET_NAME}: no vgbake for this platform, set VGBAKE_EXECUTABLE to bake ${BAKE_ASSETS}")
+        return()
+    endif()
+
+    foreach(ASSET IN ITEMS ${BAKE_ASSETS})
+        cmake_path(REPLACE_EXTENSION ASSET LAST_ONLY .vgs OUTPUT_VARIABLE BAKED_ASSET)
+        cmake_path(GET BAKED_ASSET PARENT_PATH BAKED_ASSET_DIR_PATH)
+
+        add_custom_command(
+            OUTPUT "${CMAKE_CURRENT_BINARY_DIR}/${BAKED_ASSET}"
+            COMMAND ${CMAKE_COMMAND} -E make_directory "${CMAKE_CURRENT_BINARY_DIR}/${BAKED_ASSET_DIR_PATH}"
+            COMMAND ${VGBAKE} --factors ${BAKE_FACTORS} "${CMAKE_CURRENT_SOURCE_DIR}/${ASSET}" "${CMAKE_CURRENT_BINARY_DIR}/${BAKED_ASSET}"
+            DEPENDS "${CMAKE_CURRENT_SOURCE_DIR}/${ASSET}" ${VGBAKE_DEPENDENCY}
+            COMMENT "Baking ${ASSET}"
+            VERBATIM
+        )
+        target_sources(${TARGET_NAME} PRIVATE "${CMAKE_CURRENT_BINARY_DIR}/${BAKED_ASSET}")
+
+        if(APPLE)
+            set_source_files_properties(
+                "${CMAKE_CURRENT_BINARY_DIR}/${BAKED_ASSET}"
+                PROPERTIES
+                MACOSX_PACKAGE_LOCATION Resources/${BAKED_ASSET_DIR_PATH}
+            )
+        endif()
+    endforeach()
+endfunction()
@@ -26,3 +26,7 @@ std::vector<glm::vec3> Sample00_Welcome::getVertices() const {
 std::vector<Triangle> Sample00_Welcome::getTriangles() const {
     return {};
 }
+
+size_t Sample00_Welcome::getTriangleCount() const {
+    return 0;
+}
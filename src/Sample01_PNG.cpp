@@ -79,7 +79,7 @@ void Sample01_PNG::render(const std::shared_ptr<ViewerApp> &app, const glm::mat4
     vbo->bind(program);
     ibo->bind();
     texture->bind();
-    glDrawElements(GL_TRIANGLES, ibo->indices.size(), GL_UNSIGNED_SHORT, nullptr);
+    glDrawElements(GL_TRIANGLES, ibo->indexCount, GL_UNSIGNED_SHORT, nullptr);
     texture->unbind();
     ibo->unbind();
     vbo->unbind();
@@ -114,4 +114,8 @@ std::vector<Triangle> Sample01_PNG::getTriangles() const {
         });
     }
     return result;
-}
\ No newline at end of file
+}
+
+size_t Sample01_PNG::getTriangleCount() const {
+    return ibo->indexCount / 3;
+}
@@ -20,6 +20,7 @@ public:
     virtual void renderUI() override;
     virtual std::vector<glm::vec3> getVertices() const override;
     virtual std::vector<Triangle> getTriangles() const override;
+    virtual size_t getTriangleCount() const override;
 
 private:
     std::shared_ptr<ShaderProgram> program;
@@ -2,8 +2,11 @@
 #define SAMPLE02_VG_TRIG_H
 
 #include "AbstractSample.h"
+#include "BinaryScene.h"
 #include "IndexBuffer.h"
+#include "LODMeshCache.h"
 #include "ShaderProgram.h"
+#include "TessellationCache.h"
 #include "Texture.h"
 #include "VertexBuffer.h"
 #include "VertexData.h"
@@ -20,7 +23,7 @@ public:
         Smiley,
         PacmanGame,
         AndroidSVG,
-        // TigerSVG
+        TigerSVG
     };
 
     inline Sample02_VG_Trig(const std::string &name) : AbstractSample(name) {}
@@ -31,8 +34,7 @@ public:
     virtual void renderUI() override;
     virtual std::vector<glm::vec3> getVertices() const override;
     virtual std::vector<Triangle> getTriangles() const override;
-
-    void roundedRect(Path2D &ctx, float x, float y, float width, float height, float radius) ;
+    virtual size_t getTriangleCount() const override;
 
     void draw();
     void drawHeart();
@@ -42,10 +44,25 @@ public:
     void drawTigerSVG();
 
 private:
-    Mesh mesh;
+    void drawSVG(const std::string &filePath);
+
+    LODMeshCache lodMeshCache;
+
+    // meshes of the SVG paths tessellated by the previous launches.
+    std::unique_ptr<TessellationCache> tessellationCache;
+
+    // the last SVG file loaded, kept so changing the tesselation or the curve
+    // flattener doesn't read and parse it again. Mapped from its BinaryScene
+    // instead when one was converted next to it.
+    std::string svgFilePath;
+    std::vector<Path2D> svgPaths;
+    BinaryScene svgScene;
     std::shared_ptr<ShaderProgram> program;
     std::shared_ptr<VertexBuffer<ColorVertex>> vbo;
     std::shared_ptr<IndexBuffer> ibo;
+
+    // batches of the uploaded mesh, drawn one call each.
+    std::vector<MeshBatch> batches;
     int drawMode = Heart;
 
     float tesselationFactor = 100.0f;
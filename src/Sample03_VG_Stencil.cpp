@@ -83,6 +83,11 @@ std::vector<Triangle> Sample03_VG_Stencil::getTriangles() const {
     return result;
 }
 
+// nanovg triangulates inside of its GL backend, there are no triangles to count.
+size_t Sample03_VG_Stencil::getTriangleCount() const {
+    return 0;
+}
+
 
 void Sample03_VG_Stencil::roundedRect(float x, float y, float width, float height, float radius) {
   nvgBeginPath(vg);
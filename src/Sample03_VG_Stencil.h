@@ -32,6 +32,7 @@ public:
     virtual void renderUI() override;
     virtual std::vector<glm::vec3> getVertices() const override;
     virtual std::vector<Triangle> getTriangles() const override;
+    virtual size_t getTriangleCount() const override;
 
     void roundedRect(float x, float y, float width, float height, float radius) ;
 
@@ -0,0 +1,379 @@
+// Headless tessellation benchmark.
+//
+// Runs the Sample02_VG_Trig scenes through Path2D at a sweep of tessellation
+// factors without any window or GL context and prints the results as JSON, e.g.
+//
+//   VectorGraphicViewerBench --iterations 10 --factors 10,100,500 --scenes heart,tiger
+//
+// Every scene is run once per curve flattener so their point counts and timings
+// can be compared side by side. The parallel scenes are also run once per
+// --threads count; their phase timings only cover the calling thread.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BinaryScene.h"
+#include "ParallelTessellator.h"
+#include "SampleScenes.h"
+#include "TessellationCache.h"
+#include "TessellationStats.h"
+#include "VectorGraphic.h"
+
+// GCC warns about free() on memory from operator new wherever it inlines the
+// operator delete below, not knowing the operator new is this one.
+#if defined(__GNUC__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+static std::atomic<uint64_t> s_allocationCount(0);
+static std::atomic<uint64_t> s_allocatedBytes(0);
+
+void *operator new(size_t size) {
+    s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    s_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+BENCH_NOINLINE void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+    operator delete[](ptr);
+}
+
+struct Scene {
+    const char *name;
+    std::function<void(Mesh &mesh, float tesselationFactor)> draw;
+    std::string parsedFile = std::string(); // SVG file parsed by every draw, to report the parsing throughput
+    bool parallel = false; // draws through the ParallelTessellator
+};
+
+static size_t fileSize(const std::string &filePath) {
+    FILE *file = fopen(filePath.c_str(), "rb");
+    if (!file) {
+        return 0;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size > 0 ? static_cast<size_t>(size) : 0;
+}
+
+struct RunResult {
+    double totalMs = 0.0;
+    double minTotalMs = 0.0;
+    double phaseMs[static_cast<size_t>(TessellationPhase::count)] = {};
+    uint64_t contourPoints = 0;
+    size_t vertexCount = 0;
+    size_t indexCount = 0;
+    size_t batchCount = 0;
+    uint64_t allocationCount = 0;
+    uint64_t allocatedBytes = 0;
+};
+
+static std::vector<std::string> split(const std::string &value, char separator) {
+    std::vector<std::string> result;
+    size_t start = 0;
+    while (start <= value.size()) {
+        size_t end = value.find(separator, start);
+        if (end == std::string::npos) {
+            end = value.size();
+        }
+        if (end > start) {
+            result.push_back(value.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+    return result;
+}
+
+static RunResult run(const Scene &scene, float tesselationFactor, CurveFlattener curveFlattener, uint32_t iterations) {
+    RunResult result;
+    Path2D::defaultCurveFlattener = curveFlattener;
+    result.minTotalMs = 1e30;
+
+    // warm up the caches and the allocator
+    {
+        Mesh mesh;
+        scene.draw(mesh, tesselationFactor);
+    }
+
+    for (uint32_t i = 0; i < iterations; ++i) {
+        TessellationStats::current().reset();
+        uint64_t allocationCount = s_allocationCount.load(std::memory_order_relaxed);
+        uint64_t allocatedBytes = s_allocatedBytes.load(std::memory_order_relaxed);
+
+        auto startTime = std::chrono::steady_clock::now();
+
+        Mesh mesh;
+        scene.draw(mesh, tesselationFactor);
+
+        double totalMs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count() / 1000000.0;
+
+        result.allocationCount += s_allocationCount.load(std::memory_order_relaxed) - allocationCount;
+        result.allocatedBytes += s_allocatedBytes.load(std::memory_order_relaxed) - allocatedBytes;
+        result.totalMs += totalMs;
+        result.minTotalMs = std::min(result.minTotalMs, totalMs);
+        for (size_t phase = 0; phase < static_cast<size_t>(TessellationPhase::count); ++phase) {
+            result.phaseMs[phase] += TessellationStats::current().milliseconds(static_cast<TessellationPhase>(phase));
+        }
+        result.contourPoints = TessellationStats::current().contourPoints;
+        result.vertexCount = mesh.vertices.size();
+        result.indexCount = mesh.indices.size();
+        result.batchCount = mesh.batches.size();
+    }
+
+    // report averages per iteration
+    result.totalMs /= iterations;
+    result.allocationCount /= iterations;
+    result.allocatedBytes /= iterations;
+    for (size_t phase = 0; phase < static_cast<size_t>(TessellationPhase::count); ++phase) {
+        result.phaseMs[phase] /= iterations;
+    }
+
+    return result;
+}
+
+static void printUsage(const char *executable) {
+    fprintf(stderr,
+            "usage: %s [--iterations N] [--factors F1,F2,...] [--scenes S1,S2,...] [--flatteners C1,C2,...] [--threads T1,T2,...] [--assets DIR] [--output FILE]\n"
+            "scenes: heart, smiley, pacman, pathData, android, tiger, tigerStreamed, tigerRetained, tigerParallel, tigerBinary, tigerDiskCache\n"
+            "flatteners: recursive, forwardDifferencing, batched\n",
+            executable);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t iterations = 5;
+    std::vector<float> tesselationFactors = {10.0f, 50.0f, 100.0f, 250.0f, 500.0f};
+    std::vector<std::string> sceneFilter;
+    std::vector<CurveFlattener> curveFlatteners = {CurveFlattener::recursive, CurveFlattener::forwardDifferencing, CurveFlattener::batched};
+    std::vector<uint32_t> threadCounts = {1, std::max(1u, std::thread::hardware_concurrency())};
+    std::string assetDir = "assets";
+    std::string outputPath;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--iterations") == 0 && hasValue) {
+            iterations = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--factors") == 0 && hasValue) {
+            tesselationFactors.clear();
+            for (const std::string &factor : split(argv[++i], ',')) {
+                tesselationFactors.push_back(static_cast<float>(atof(factor.c_str())));
+            }
+        } else if (strcmp(argv[i], "--scenes") == 0 && hasValue) {
+            sceneFilter = split(argv[++i], ',');
+        } else if (strcmp(argv[i], "--flatteners") == 0 && hasValue) {
+            curveFlatteners.clear();
+            for (const std::string &name : split(argv[++i], ',')) {
+                if (name == curveFlattenerToString(CurveFlattener::recursive)) {
+                    curveFlatteners.push_back(CurveFlattener::recursive);
+                } else if (name == curveFlattenerToString(CurveFlattener::forwardDifferencing)) {
+                    curveFlatteners.push_back(CurveFlattener::forwardDifferencing);
+                } else if (name == curveFlattenerToString(CurveFlattener::batched)) {
+                    curveFlatteners.push_back(CurveFlattener::batched);
+                } else {
+                    printUsage(argv[0]);
+                    return 1;
+                }
+            }
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threadCounts.clear();
+            for (const std::string &threadCount : split(argv[++i], ',')) {
+                threadCounts.push_back(static_cast<uint32_t>(std::max(1, atoi(threadCount.c_str()))));
+            }
+        } else if (strcmp(argv[i], "--assets") == 0 && hasValue) {
+            assetDir = argv[++i];
+        } else if (strcmp(argv[i], "--output") == 0 && hasValue) {
+            outputPath = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    // e.g. the default "1,1" on a single core, every configuration runs once.
+    std::vector<uint32_t> uniqueThreadCounts;
+    for (uint32_t threadCount : threadCounts) {
+        if (std::find(uniqueThreadCounts.begin(), uniqueThreadCounts.end(), threadCount) == uniqueThreadCounts.end()) {
+            uniqueThreadCounts.push_back(threadCount);
+        }
+    }
+    threadCounts = uniqueThreadCounts;
+
+    const std::string androidPath = assetDir + "/android.svg";
+    const std::string tigerPath = assetDir + "/Ghostscript_Tiger.svg";
+    const std::string tigerScenePath = (std::filesystem::temp_directory_path() / "VectorGraphicViewerBench_tiger.vgs").string();
+    std::vector<Path2D> tigerPaths;
+    bool tigerSceneWritten = false;
+    CurveFlattener tigerSceneCurveFlattener = Path2D::defaultCurveFlattener;
+    const std::string tessellationCacheDirectory = (std::filesystem::temp_directory_path() / "VectorGraphicViewerBench_cache").string();
+    std::unique_ptr<TessellationCache> tessellationCache;
+    std::unique_ptr<ParallelTessellator> parallelTessellator;
+
+    const std::vector<Scene> scenes = {
+        {"heart", drawHeart},
+        {"smiley", drawSmiley},
+        {"pacman", drawPacmanGame},
+        {"pathData", [](Mesh &mesh, float tesselationFactor) {
+            // subpaths going on after 'Z' from where the closed ones started,
+            // with relative and absolute commands.
+            Path2D path(tesselationFactor, "M10 10 L20 10 L20 20 Z l5 5 h-10 z c5 0 10 5 10 10 s-5 10 -10 10 z"
+                                           "M40 10 h10 v10 h-10 Z L45 30 L35 30 Z q5 5 10 0 t10 0 Z a5 5 0 1 0 10 0 z");
+            path.fillStyle = Crimson;
+            path.fill(mesh);
+            path.strokeStyle = DarkMagenta;
+            path.stroke(mesh);
+        }},
+        {"android", [&](Mesh &mesh, float tesselationFactor) { drawSVGFile(mesh, androidPath, tesselationFactor); }, androidPath},
+        {"tiger", [&](Mesh &mesh, float tesselationFactor) { drawSVGFile(mesh, tigerPath, tesselationFactor); }, tigerPath},
+        {"tigerStreamed", [&](Mesh &mesh, float tesselationFactor) { streamSVGFile(mesh, tigerPath, tesselationFactor); }, tigerPath},
+        {"tigerRetained", [&](Mesh &mesh, float tesselationFactor) {
+            // parsed once and kept, like the viewer does. The paths are only
+            // flattened again when the tesselation factor changes.
+            if (tigerPaths.empty()) {
+                tigerPaths = Path2D::fromSVGFile(tigerPath, Unit::px, 96, tesselationFactor);
+            }
+            for (Path2D &path : tigerPaths) {
+                path.curveFlattener = Path2D::defaultCurveFlattener;
+            }
+            drawSVGPaths(mesh, tigerPaths, tesselationFactor);
+        }},
+        {"tigerParallel", [&](Mesh &mesh, float tesselationFactor) {
+            // retained as well, so only the tessellation is measured
+            if (tigerPaths.empty()) {
+                tigerPaths = Path2D::fromSVGFile(tigerPath, Unit::px, 96, tesselationFactor);
+            }
+            for (Path2D &path : tigerPaths) {
+                path.curveFlattener = Path2D::defaultCurveFlattener;
+            }
+            drawSVGPaths(mesh, tigerPaths, tesselationFactor, *parallelTessellator);
+        }, std::string(), true},
+        {"tigerBinary", [&](Mesh &mesh, float tesselationFactor) {
+            // converted once per curve flattener, with its meshes baked for
+            // every --factors. Every draw maps the scene again and appends the
+            // meshes of its factor.
+            if (!tigerSceneWritten || tigerSceneCurveFlattener != Path2D::defaultCurveFlattener) {
+                tigerSceneWritten = writeBinaryScene(tigerPath, tigerScenePath, tesselationFactors);
+                tigerSceneCurveFlattener = Path2D::defaultCurveFlattener;
+            }
+            BinaryScene scene;
+            if (!scene.open(tigerScenePath)) {
+                fprintf(stderr, "Could not open %s: %s\n", tigerScenePath.c_str(), scene.error());
+                return;
+            }
+            drawBinaryScene(mesh, scene, tesselationFactor);
+        }, tigerScenePath},
+        {"tigerDiskCache", [&](Mesh &mesh, float tesselationFactor) {
+            // retained, with an empty cache on start: the warm up run fills
+            // it, the measured ones only load from it.
+            if (!tessellationCache) {
+                std::error_code error;
+                std::filesystem::remove_all(tessellationCacheDirectory, error);
+                tessellationCache.reset(new TessellationCache(tessellationCacheDirectory));
+            }
+            if (tigerPaths.empty()) {
+                tigerPaths = Path2D::fromSVGFile(tigerPath, Unit::px, 96, tesselationFactor);
+            }
+            for (Path2D &path : tigerPaths) {
+                path.curveFlattener = Path2D::defaultCurveFlattener;
+            }
+            drawSVGPaths(mesh, tigerPaths, tesselationFactor, *tessellationCache);
+        }},
+    };
+
+    FILE *output = stdout;
+    if (!outputPath.empty()) {
+        output = fopen(outputPath.c_str(), "w");
+        if (!output) {
+            fprintf(stderr, "Could not open %s\n", outputPath.c_str());
+            return 1;
+        }
+    }
+
+    fprintf(output, "{\n");
+    fprintf(output, "  \"benchmark\": \"VectorGraphicViewerBench\",\n");
+    fprintf(output, "  \"iterations\": %u,\n", iterations);
+    fprintf(output, "  \"runs\": [");
+
+    bool firstRun = true;
+    for (const Scene &scene : scenes) {
+        if (!sceneFilter.empty() && std::find(sceneFilter.begin(), sceneFilter.end(), scene.name) == sceneFilter.end()) {
+            continue;
+        }
+
+        for (uint32_t threadCount : scene.parallel ? threadCounts : std::vector<uint32_t>{1}) {
+            if (scene.parallel) {
+                parallelTessellator.reset(new ParallelTessellator(threadCount));
+            }
+            for (CurveFlattener curveFlattener : curveFlatteners) {
+                for (float tesselationFactor : tesselationFactors) {
+                    RunResult result = run(scene, tesselationFactor, curveFlattener, iterations);
+
+                    fprintf(output, "%s\n    {\n", firstRun ? "" : ",");
+                    fprintf(output, "      \"scene\": \"%s\",\n", scene.name);
+                    fprintf(output, "      \"curveFlattener\": \"%s\",\n", curveFlattenerToString(curveFlattener));
+                    fprintf(output, "      \"tesselationFactor\": %g,\n", tesselationFactor);
+                    fprintf(output, "      \"threads\": %u,\n", threadCount);
+                    fprintf(output, "      \"totalMs\": %.4f,\n", result.totalMs);
+                    fprintf(output, "      \"minTotalMs\": %.4f,\n", result.minTotalMs);
+                    fprintf(output, "      \"phasesMs\": {");
+                    for (size_t phase = 0; phase < static_cast<size_t>(TessellationPhase::count); ++phase) {
+                        fprintf(output, "%s\"%s\": %.4f", phase == 0 ? "" : ", ", tessellationPhaseToString(static_cast<TessellationPhase>(phase)), result.phaseMs[phase]);
+                    }
+                    fprintf(output, "},\n");
+                    double parseMs = result.phaseMs[static_cast<size_t>(TessellationPhase::parse)];
+                    if (!scene.parsedFile.empty() && parseMs > 0.0) {
+                        fprintf(output, "      \"parseMBps\": %.1f,\n", fileSize(scene.parsedFile) / (parseMs * 1000.0));
+                    }
+                    fprintf(output, "      \"contourPoints\": %llu,\n", static_cast<unsigned long long>(result.contourPoints));
+                    fprintf(output, "      \"vertexCount\": %zu,\n", result.vertexCount);
+                    fprintf(output, "      \"indexCount\": %zu,\n", result.indexCount);
+                    fprintf(output, "      \"batchCount\": %zu,\n", result.batchCount);
+                    fprintf(output, "      \"allocationCount\": %llu,\n", static_cast<unsigned long long>(result.allocationCount));
+                    fprintf(output, "      \"allocatedBytes\": %llu\n", static_cast<unsigned long long>(result.allocatedBytes));
+                    fprintf(output, "    }");
+                    fflush(output);
+                    firstRun = false;
+                }
+            }
+        }
+    }
+
+    fprintf(output, "\n  ]\n}\n");
+
+    if (output != stdout) {
+        fclose(output);
+    }
+
+    return 0;
+}
@@ -4,11 +4,15 @@
 #include <vector>
 
 std::map<std::string, AbstractGPUObject*> AbstractGPUObject::registry;
+bool AbstractGPUObject::keepShadowCopies = false;
+bool AbstractGPUObject::shadowCopiesInspected = false;
+
+static std::string printableBytes(size_t bytes);
 
 AbstractGPUObject::AbstractGPUObject(const std::string &name) 
     : name(name) 
 {
-	if (name[0] != '#') {
+	if (isRegistered()) {
 		printf("Registering '%s'\n", name.c_str());
 		assert(registry.find(name) == registry.end());
 		registry[name] = this;
@@ -16,7 +20,7 @@ AbstractGPUObject::AbstractGPUObject(const std::string &name)
 }
 
 AbstractGPUObject::~AbstractGPUObject() {
-	if (name[0] != '#') {
+	if (isRegistered()) {
 		printf("Unregistering '%s'\n", name.c_str());
 	    int count = registry.erase(name);
 		assert(count == 1);
@@ -24,13 +28,21 @@ AbstractGPUObject::~AbstractGPUObject() {
 }
 
 std::string AbstractGPUObject::getPrintableMemoryUsage() const
+{
+	return printableBytes(getMemoryUsage());
+}
+
+std::string AbstractGPUObject::getPrintableShadowMemoryUsage() const
+{
+	return printableBytes(getShadowMemoryUsage());
+}
+
+static std::string printableBytes(size_t bytes)
 {
 	static std::vector<std::string> suffix = {"B", "KB", "MB", "GB", "TB"};
 
 	int i = 0;
 
-    size_t bytes = getMemoryUsage();
-
 	double dblBytes = bytes;
 
 	if (bytes > 1024) {
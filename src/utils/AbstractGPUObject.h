@@ -10,14 +10,37 @@ struct AbstractGPUObject {
 
     static std::map<std::string, AbstractGPUObject*> registry;
 
+    // Whether the buffers keep a CPU copy of what they upload, for the
+    // inspectors reading it back (e.g. AbstractSample::getTriangles()). Only
+    // the registered objects keep one.
+    static bool keepShadowCopies;
+
+    // set by the renderUI() reading the copies, e.g. an expanded buffer.
+    static bool shadowCopiesInspected;
+
     std::string name;
 
     AbstractGPUObject(const std::string &name);
     virtual ~AbstractGPUObject();
 
+    // objects named '#...' are internal to the viewer and not in the registry.
+    inline bool isRegistered() const {
+        return name[0] != '#';
+    }
+
     std::string getPrintableMemoryUsage() const;
+    std::string getPrintableShadowMemoryUsage() const;
 
+    // memory used on the GPU.
     virtual size_t getMemoryUsage() const = 0;
+
+    // memory used by the CPU copy of the GPU data, if any.
+    virtual size_t getShadowMemoryUsage() const {
+        return 0;
+    }
+
+    virtual void releaseShadowCopy() {}
+
     virtual void renderUI() = 0;
 
 };
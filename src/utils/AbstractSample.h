@@ -25,6 +25,9 @@ public:
     virtual std::vector<glm::vec3> getVertices() const = 0;
     virtual std::vector<Triangle> getTriangles() const = 0;
 
+    // unlike getTriangles(), available without the shadow copies of the buffers.
+    virtual size_t getTriangleCount() const = 0;
+
     const std::string &name() const {
         return m_name;
     }
@@ -0,0 +1,468 @@
+#include "BinaryScene.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <type_traits>
+#include <unordered_map>
+
+#include "TessellationStats.h"
+
+static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+static constexpr uint64_t SECTION_ALIGNMENT = 16;
+
+struct BinaryScene::Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t pathCount;
+    uint32_t styleCount;
+    uint32_t lodCount;
+    uint32_t commandCount;
+    uint32_t paramCount;
+    uint64_t pathOffset;
+    uint64_t styleOffset;
+    uint64_t commandOffset;
+    uint64_t paramOffset;
+    uint64_t lodOffset;
+    uint64_t fileSize;
+};
+
+struct BinaryScene::PathRecord {
+    uint32_t firstCommand;
+    uint32_t commandCount;
+    uint32_t firstParam;
+    uint32_t paramCount;
+    uint32_t style;
+    float bounds[4]; // min x, min y, max x, max y
+};
+
+struct BinaryScene::StyleRecord {
+    uint8_t fillStyle[4];
+    uint8_t strokeStyle[4];
+    float lineWidth;
+    float miterLimit;
+    float transform[6]; // a, b, c, d, e, f
+    uint8_t lineJoin;
+    uint8_t lineCap;
+    uint8_t fillRule;
+    uint8_t curveFlattener; // the one the baked meshes of the path were flattened with
+};
+
+struct BinaryScene::LodRecord {
+    float tesselationFactor;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t batchCount;
+    uint64_t pathMeshOffset;
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    uint64_t batchOffset;
+};
+
+struct BinaryScene::PathMeshRecord {
+    uint32_t firstVertex;
+    uint32_t vertexCount;
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    uint32_t firstBatch;
+    uint32_t batchCount;
+};
+
+// the vertices are uploaded as they are stored.
+static_assert(sizeof(ColorVertex) == 16 && std::is_trivially_copyable<ColorVertex>::value, "ColorVertex isn't stored as is");
+static_assert(sizeof(MeshBatch) == 8, "MeshBatch isn't stored as is");
+
+static inline uint64_t align(uint64_t offset) {
+    return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+}
+
+namespace
+{
+    // file content, built in memory and written at once.
+    class Writer
+    {
+    public:
+        // appends 'count' elements in a new section and returns its offset.
+        template <typename T>
+        uint64_t section(const T *data, size_t count) {
+            uint64_t offset = align(bytes.size());
+            bytes.resize(offset + count * sizeof(T));
+            if (count) {
+                memcpy(bytes.data() + offset, data, count * sizeof(T));
+            }
+            return offset;
+        }
+
+        template <typename T>
+        inline uint64_t section(const std::vector<T> &data) {
+            return section(data.data(), data.size());
+        }
+
+        template <typename T>
+        inline T *at(uint64_t offset) {
+            return reinterpret_cast<T *>(bytes.data() + offset);
+        }
+
+        std::vector<char> bytes;
+    };
+}
+
+bool BinaryScene::write(const std::string &filePath, std::vector<Path2D> &paths, const std::vector<float> &lodTesselationFactors, const Tessellate &tessellate) {
+    std::vector<PathRecord> pathRecords;
+    std::vector<StyleRecord> styles;
+    std::vector<uint8_t> commands;
+    std::vector<float> params;
+    pathRecords.reserve(paths.size());
+
+    // most paths of a document share their style with others.
+    std::unordered_map<std::string, uint32_t> styleIndices;
+
+    for (Path2D &path : paths) {
+        StyleRecord style = {};
+        memcpy(style.fillStyle, &path.fillStyle[0], 4);
+        memcpy(style.strokeStyle, &path.strokeStyle[0], 4);
+        style.lineWidth = path.lineWidth;
+        style.miterLimit = path.miterLimit;
+        const Transform2D &transform = path.getTransform();
+        const float transformParams[6] = {transform.a, transform.b, transform.c, transform.d, transform.e, transform.f};
+        memcpy(style.transform, transformParams, sizeof(transformParams));
+        style.lineJoin = static_cast<uint8_t>(path.lineJoin);
+        style.lineCap = static_cast<uint8_t>(path.lineCap);
+        style.fillRule = static_cast<uint8_t>(path.fillRule);
+        style.curveFlattener = static_cast<uint8_t>(path.curveFlattener);
+
+        auto inserted = styleIndices.emplace(std::string(reinterpret_cast<const char *>(&style), sizeof(style)), static_cast<uint32_t>(styles.size()));
+        if (inserted.second) {
+            styles.push_back(style);
+        }
+
+        BoundingBox bounds = path.getBounds();
+        PathRecord record = {};
+        record.firstCommand = static_cast<uint32_t>(commands.size());
+        record.commandCount = static_cast<uint32_t>(path.commands.size());
+        record.firstParam = static_cast<uint32_t>(params.size());
+        record.paramCount = static_cast<uint32_t>(path.commandParams.size());
+        record.style = inserted.first->second;
+        record.bounds[0] = bounds.min.x;
+        record.bounds[1] = bounds.min.y;
+        record.bounds[2] = bounds.max.x;
+        record.bounds[3] = bounds.max.y;
+        pathRecords.push_back(record);
+
+        for (PathCommand command : path.commands) {
+            commands.push_back(static_cast<uint8_t>(command));
+        }
+        params.insert(params.end(), path.commandParams.begin(), path.commandParams.end());
+    }
+
+    Writer writer;
+    writer.section(std::vector<Header>(1));
+    Header header = {};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.pathCount = static_cast<uint32_t>(pathRecords.size());
+    header.styleCount = static_cast<uint32_t>(styles.size());
+    header.lodCount = static_cast<uint32_t>(lodTesselationFactors.size());
+    header.commandCount = static_cast<uint32_t>(commands.size());
+    header.paramCount = static_cast<uint32_t>(params.size());
+    header.pathOffset = writer.section(pathRecords);
+    header.styleOffset = writer.section(styles);
+    header.commandOffset = writer.section(commands);
+    header.paramOffset = writer.section(params);
+    header.lodOffset = writer.section(std::vector<LodRecord>(lodTesselationFactors.size()));
+
+    Mesh pathMesh;
+    Mesh lodMesh; // every path mesh, one after the other, keeping their own batches
+    std::vector<PathMeshRecord> pathMeshes;
+    for (size_t lod = 0; lod < lodTesselationFactors.size(); ++lod) {
+        lodMesh.clear();
+        pathMeshes.clear();
+        for (Path2D &path : paths) {
+            pathMesh.clear();
+            tessellate(pathMesh, path, lodTesselationFactors[lod]);
+
+            PathMeshRecord record;
+            record.firstVertex = static_cast<uint32_t>(lodMesh.vertices.size());
+            record.vertexCount = static_cast<uint32_t>(pathMesh.vertices.size());
+            record.firstIndex = static_cast<uint32_t>(lodMesh.indices.size());
+            record.indexCount = static_cast<uint32_t>(pathMesh.indices.size());
+            record.firstBatch = static_cast<uint32_t>(lodMesh.batches.size());
+            record.batchCount = static_cast<uint32_t>(pathMesh.batches.size());
+            pathMeshes.push_back(record);
+
+            lodMesh.vertices.insert(lodMesh.vertices.end(), pathMesh.vertices.begin(), pathMesh.vertices.end());
+            lodMesh.indices.insert(lodMesh.indices.end(), pathMesh.indices.begin(), pathMesh.indices.end());
+            lodMesh.batches.insert(lodMesh.batches.end(), pathMesh.batches.begin(), pathMesh.batches.end());
+        }
+
+        LodRecord record = {};
+        record.tesselationFactor = lodTesselationFactors[lod];
+        record.vertexCount = static_cast<uint32_t>(lodMesh.vertices.size());
+        record.indexCount = static_cast<uint32_t>(lodMesh.indices.size());
+        record.batchCount = static_cast<uint32_t>(lodMesh.batches.size());
+        record.pathMeshOffset = writer.section(pathMeshes);
+        record.vertexOffset = writer.section(lodMesh.vertices);
+        record.indexOffset = writer.section(lodMesh.indices);
+        record.batchOffset = writer.section(lodMesh.batches);
+        *writer.at<LodRecord>(header.lodOffset + lod * sizeof(LodRecord)) = record;
+    }
+
+    header.fileSize = writer.bytes.size();
+    *writer.at<Header>(0) = header;
+
+    // written next to it then renamed, so an interrupted write doesn't leave
+    // a truncated scene behind.
+    std::string temporaryPath = filePath + ".tmp";
+    FILE *file = fopen(temporaryPath.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool written = fwrite(writer.bytes.data(), 1, writer.bytes.size(), file) == writer.bytes.size();
+    written = fclose(file) == 0 && written;
+
+    std::error_code error;
+    if (written) {
+        std::filesystem::rename(temporaryPath, filePath, error);
+    }
+    if (!written || error) {
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+    return true;
+}
+
+bool BinaryScene::open(const std::string &filePath) {
+    VG_PROFILE_PHASE(parse);
+
+    close();
+    if (!m_file.open(filePath)) {
+        return fail("Could not open the file");
+    }
+    if (!validate()) {
+        m_file.close();
+        m_header = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void BinaryScene::close() {
+    m_file.close();
+    m_error = nullptr;
+    m_header = nullptr;
+    m_paths = nullptr;
+    m_styles = nullptr;
+    m_commands = nullptr;
+    m_params = nullptr;
+    m_lods = nullptr;
+}
+
+bool BinaryScene::validate() {
+    const char *data = m_file.data();
+    uint64_t size = m_file.size();
+
+    // 'count' elements of 'elementSize' bytes at 'offset', all inside of the file.
+    auto inFile = [size](uint64_t offset, uint64_t count, uint64_t elementSize) {
+        return offset % SECTION_ALIGNMENT == 0 && offset <= size && count <= (size - offset) / elementSize;
+    };
+
+    if (size < sizeof(Header)) {
+        return fail("Not a vector scene");
+    }
+    const Header *header = reinterpret_cast<const Header *>(data);
+    if (header->magic != MAGIC) {
+        return fail("Not a vector scene");
+    }
+    if (header->byteOrder != BYTE_ORDER_MARK) {
+        return fail("Vector scene written with another byte order");
+    }
+    if (header->version != VERSION) {
+        return fail("Unsupported vector scene version");
+    }
+    if (header->fileSize != size ||
+        !inFile(header->pathOffset, header->pathCount, sizeof(PathRecord)) ||
+        !inFile(header->styleOffset, header->styleCount, sizeof(StyleRecord)) ||
+        !inFile(header->commandOffset, header->commandCount, sizeof(uint8_t)) ||
+        !inFile(header->paramOffset, header->paramCount, sizeof(float)) ||
+        !inFile(header->lodOffset, header->lodCount, sizeof(LodRecord))) {
+        return fail("Truncated vector scene");
+    }
+
+    const PathRecord *paths = reinterpret_cast<const PathRecord *>(data + header->pathOffset);
+    const StyleRecord *styles = reinterpret_cast<const StyleRecord *>(data + header->styleOffset);
+    const uint8_t *commands = reinterpret_cast<const uint8_t *>(data + header->commandOffset);
+    const LodRecord *lods = reinterpret_cast<const LodRecord *>(data + header->lodOffset);
+
+    for (uint32_t i = 0; i < header->styleCount; ++i) {
+        if (styles[i].lineJoin > static_cast<uint8_t>(LineJoin::miter) ||
+            styles[i].lineCap > static_cast<uint8_t>(LineCap::square) ||
+            styles[i].fillRule > static_cast<uint8_t>(FillRule::evenOdd) ||
+            styles[i].curveFlattener > static_cast<uint8_t>(CurveFlattener::batched)) {
+            return fail("Invalid style in vector scene");
+        }
+    }
+
+    // flatten() reads as many parameters as the commands take, so they have to add up.
+    for (uint32_t i = 0; i < header->pathCount; ++i) {
+        const PathRecord &path = paths[i];
+        if (static_cast<uint64_t>(path.firstCommand) + path.commandCount > header->commandCount ||
+            static_cast<uint64_t>(path.firstParam) + path.paramCount > header->paramCount ||
+            path.style >= header->styleCount) {
+            return fail("Invalid path in vector scene");
+        }
+        uint64_t paramCount = 0;
+        for (uint32_t command = path.firstCommand; command < path.firstCommand + path.commandCount; ++command) {
+            if (commands[command] > static_cast<uint8_t>(PathCommand::closePath)) {
+                return fail("Invalid path command in vector scene");
+            }
+            paramCount += pathCommandParamCount(static_cast<PathCommand>(commands[command]));
+        }
+        if (paramCount != path.paramCount) {
+            return fail("Invalid path in vector scene");
+        }
+    }
+
+    for (uint32_t lod = 0; lod < header->lodCount; ++lod) {
+        const LodRecord &record = lods[lod];
+        if (!inFile(record.pathMeshOffset, header->pathCount, sizeof(PathMeshRecord)) ||
+            !inFile(record.vertexOffset, record.vertexCount, sizeof(ColorVertex)) ||
+            !inFile(record.indexOffset, record.indexCount, sizeof(uint16_t)) ||
+            !inFile(record.batchOffset, record.batchCount, sizeof(MeshBatch))) {
+            return fail("Truncated vector scene");
+        }
+
+        const PathMeshRecord *pathMeshes = reinterpret_cast<const PathMeshRecord *>(data + record.pathMeshOffset);
+        const MeshBatch *batches = reinterpret_cast<const MeshBatch *>(data + record.batchOffset);
+        for (uint32_t i = 0; i < header->pathCount; ++i) {
+            const PathMeshRecord &mesh = pathMeshes[i];
+            if (static_cast<uint64_t>(mesh.firstVertex) + mesh.vertexCount > record.vertexCount ||
+                static_cast<uint64_t>(mesh.firstIndex) + mesh.indexCount > record.indexCount ||
+                static_cast<uint64_t>(mesh.firstBatch) + mesh.batchCount > record.batchCount) {
+                return fail("Invalid mesh in vector scene");
+            }
+            // batches in order, each one within the 16 bits indices
+            uint32_t vertexOffset = 0;
+            uint32_t indexOffset = 0;
+            for (uint32_t batch = 0; batch < mesh.batchCount; ++batch) {
+                const MeshBatch &meshBatch = batches[mesh.firstBatch + batch];
+                uint32_t vertexEnd = batch + 1 < mesh.batchCount ? batches[mesh.firstBatch + batch + 1].vertexOffset : mesh.vertexCount;
+                uint32_t indexEnd = batch + 1 < mesh.batchCount ? batches[mesh.firstBatch + batch + 1].indexOffset : mesh.indexCount;
+                if (meshBatch.vertexOffset < vertexOffset || meshBatch.indexOffset < indexOffset ||
+                    vertexEnd < meshBatch.vertexOffset || vertexEnd > mesh.vertexCount ||
+                    indexEnd < meshBatch.indexOffset || indexEnd > mesh.indexCount ||
+                    vertexEnd - meshBatch.vertexOffset > Mesh::MAX_BATCH_VERTEX_COUNT) {
+                    return fail("Invalid mesh in vector scene");
+                }
+                vertexOffset = meshBatch.vertexOffset;
+                indexOffset = meshBatch.indexOffset;
+            }
+            if (mesh.batchCount == 0 && (mesh.vertexCount != 0 || mesh.indexCount != 0)) {
+                return fail("Invalid mesh in vector scene");
+            }
+        }
+    }
+
+    m_header = header;
+    m_paths = paths;
+    m_styles = styles;
+    m_commands = commands;
+    m_params = reinterpret_cast<const float *>(data + header->paramOffset);
+    m_lods = lods;
+    return true;
+}
+
+bool BinaryScene::fail(const char *error) {
+    m_error = error;
+    return false;
+}
+
+size_t BinaryScene::pathCount() const {
+    return m_header ? m_header->pathCount : 0;
+}
+
+Path2D BinaryScene::path(size_t index, float tesselationFactor) const {
+    const PathRecord &record = m_paths[index];
+    const StyleRecord &style = m_styles[record.style];
+
+    Path2D result(tesselationFactor);
+    const PathCommand *commands = reinterpret_cast<const PathCommand *>(m_commands + record.firstCommand);
+    result.commands.assign(commands, commands + record.commandCount);
+    result.commandParams.assign(m_params + record.firstParam, m_params + record.firstParam + record.paramCount);
+
+    result.fillStyle = Color(style.fillStyle[0], style.fillStyle[1], style.fillStyle[2]);
+    result.fillStyle.a = style.fillStyle[3];
+    result.strokeStyle = Color(style.strokeStyle[0], style.strokeStyle[1], style.strokeStyle[2]);
+    result.strokeStyle.a = style.strokeStyle[3];
+    result.lineWidth = style.lineWidth;
+    result.miterLimit = style.miterLimit;
+    result.lineJoin = static_cast<LineJoin>(style.lineJoin);
+    result.lineCap = static_cast<LineCap>(style.lineCap);
+    result.fillRule = static_cast<FillRule>(style.fillRule);
+    result.setTransform(Transform2D::matrix(style.transform[0], style.transform[1], style.transform[2],
+                                            style.transform[3], style.transform[4], style.transform[5]));
+    return result;
+}
+
+std::vector<Path2D> BinaryScene::paths(float tesselationFactor) const {
+    std::vector<Path2D> result;
+    result.reserve(pathCount());
+    for (size_t i = 0; i < pathCount(); ++i) {
+        result.push_back(path(i, tesselationFactor));
+    }
+    return result;
+}
+
+BoundingBox BinaryScene::pathBounds(size_t index) const {
+    const PathRecord &record = m_paths[index];
+    BoundingBox bounds;
+    bounds.min = glm::vec2(record.bounds[0], record.bounds[1]);
+    bounds.max = glm::vec2(record.bounds[2], record.bounds[3]);
+    return bounds;
+}
+
+CurveFlattener BinaryScene::pathCurveFlattener(size_t index) const {
+    return static_cast<CurveFlattener>(m_styles[m_paths[index].style].curveFlattener);
+}
+
+size_t BinaryScene::lodCount() const {
+    return m_header ? m_header->lodCount : 0;
+}
+
+float BinaryScene::lodTesselationFactor(size_t lod) const {
+    return m_lods[lod].tesselationFactor;
+}
+
+size_t BinaryScene::findLod(float tesselationFactor) const {
+    for (size_t lod = 0; lod < lodCount(); ++lod) {
+        if (m_lods[lod].tesselationFactor == tesselationFactor) {
+            return lod;
+        }
+    }
+    return noLod;
+}
+
+MeshView BinaryScene::pathMesh(size_t lod, size_t index) const {
+    const char *data = m_file.data();
+    const LodRecord &lodRecord = m_lods[lod];
+    const PathMeshRecord &record = reinterpret_cast<const PathMeshRecord *>(data + lodRecord.pathMeshOffset)[index];
+
+    MeshView view;
+    view.vertices = reinterpret_cast<const ColorVertex *>(data + lodRecord.vertexOffset) + record.firstVertex;
+    view.vertexCount = record.vertexCount;
+    view.indices = reinterpret_cast<const uint16_t *>(data + lodRecord.indexOffset) + record.firstIndex;
+    view.indexCount = record.indexCount;
+    view.batches = reinterpret_cast<const MeshBatch *>(data + lodRecord.batchOffset) + record.firstBatch;
+    view.batchCount = record.batchCount;
+    return view;
+}
+
+bool BinaryScene::appendPathMesh(Mesh &mesh, size_t lod, size_t index) const {
+    MeshView view = pathMesh(lod, index);
+    if (!view.isValid()) {
+        return false;
+    }
+    mesh.append(view);
+    return true;
+}
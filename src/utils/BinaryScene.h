@@ -0,0 +1,115 @@
+#ifndef BINARY_SCENE_H
+#define BINARY_SCENE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+#include "VectorGraphic.h"
+
+// Precompiled vector scene (*.vgs): the paths of an SVG document as Path2D
+// records them, plus meshes tessellated ahead of time for a few tesselation
+// factors (LODs). The file is mapped and used in place: nothing is parsed,
+// a path is rebuilt by copying its command and parameter ranges, and a baked
+// mesh is appended straight from the mapping.
+//
+// Layout, every section 16 bytes aligned, offsets from the start of the file,
+// in the byte order of the machine that wrote it (open() rejects the others):
+//
+//   Header
+//   PathRecord[pathCount]      commands, parameters, style and bounds of each path
+//   StyleRecord[styleCount]    styles shared by the paths
+//   uint8_t[commandCount]      PathCommand of all the paths
+//   float[paramCount]          their parameters
+//   LodRecord[lodCount]
+//   then for every LOD:
+//     PathMeshRecord[pathCount]  the mesh of each path, a Mesh of its own
+//     ColorVertex[vertexCount]
+//     uint16_t[indexCount]       relative to the batch, as in Mesh
+//     MeshBatch[batchCount]      relative to the path mesh
+class BinaryScene
+{
+public:
+    // how a path turns into triangles, e.g. drawSVGPath().
+    using Tessellate = std::function<void(Mesh &mesh, Path2D &path, float tesselationFactor)>;
+
+    static constexpr uint32_t MAGIC = 0x43534756; // "VGSC"
+    static constexpr uint32_t VERSION = 2;
+    static constexpr size_t noLod = SIZE_MAX;
+
+    // Writes 'paths' and, for every factor of 'lodTesselationFactors', the
+    // meshes 'tessellate' makes of them with their curveFlattener. Returns
+    // false if the file can't be written.
+    static bool write(const std::string &filePath, std::vector<Path2D> &paths, const std::vector<float> &lodTesselationFactors, const Tessellate &tessellate);
+
+    BinaryScene() = default;
+
+    BinaryScene(const BinaryScene &) = delete;
+    BinaryScene &operator=(const BinaryScene &) = delete;
+
+    // Maps the file and checks that every table stays inside of it. Returns
+    // false, see error(), if it can't be read or isn't a scene of this
+    // version.
+    bool open(const std::string &filePath);
+    void close();
+
+    inline bool isOpen() const {
+        return m_header != nullptr;
+    }
+
+    inline const char *error() const {
+        return m_error;
+    }
+
+    size_t pathCount() const;
+
+    // path 'index' with its style, ready to be flattened at 'tesselationFactor'.
+    Path2D path(size_t index, float tesselationFactor) const;
+    std::vector<Path2D> paths(float tesselationFactor) const;
+
+    // same as path(index).getBounds(), without building the path.
+    BoundingBox pathBounds(size_t index) const;
+
+    // the curve flattener the baked meshes of path 'index' were made with.
+    // path() uses Path2D::defaultCurveFlattener, like every new Path2D.
+    CurveFlattener pathCurveFlattener(size_t index) const;
+
+    size_t lodCount() const;
+    float lodTesselationFactor(size_t lod) const;
+
+    // LOD baked for exactly 'tesselationFactor', or noLod.
+    size_t findLod(float tesselationFactor) const;
+
+    // baked mesh of path 'index', pointing into the mapping.
+    MeshView pathMesh(size_t lod, size_t index) const;
+
+    // Appends the baked mesh of path 'index' to 'mesh'. Returns false, leaving
+    // 'mesh' untouched, if an index points past its batch, which the checks of
+    // open() don't go as far as reading.
+    bool appendPathMesh(Mesh &mesh, size_t lod, size_t index) const;
+
+    struct Header;
+    struct PathRecord;
+    struct StyleRecord;
+    struct LodRecord;
+    struct PathMeshRecord;
+
+private:
+    bool validate();
+    bool fail(const char *error);
+
+    MappedFile m_file;
+    const char *m_error = nullptr;
+
+    const Header *m_header = nullptr;
+    const PathRecord *m_paths = nullptr;
+    const StyleRecord *m_styles = nullptr;
+    const uint8_t *m_commands = nullptr;
+    const float *m_params = nullptr;
+    const LodRecord *m_lods = nullptr;
+};
+
+#endif // BINARY_SCENE_H
@@ -1,7 +1,10 @@
 #include "Color.h"
 
-#include <cstring>
-#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+#include "PerfectHash.h"
+#include "StringUtils.h"
 
 #define RGBA_COLOR(COLOR_NAME, r, g, b, a) const Color COLOR_NAME = Color(r, g, b, a)
 #define RGB_COLOR(COLOR_NAME, r, g, b) RGBA_COLOR(COLOR_NAME, r, g, b, 1.0f)
@@ -171,251 +174,386 @@ RGB_COLOR(SlateGray, 112, 128, 144);
 RGB_COLOR(DarkSlateGray, 47, 79, 79);
 RGB_COLOR(Black, 0, 0, 0);
 
-Color::Color(const char* colorName)
-{
-    if (colorName[0] == '#')
-    {
-        Color color;
-        uint32_t word = static_cast<uint32_t>(strtol(&colorName[1], nullptr, 16));
-        size_t colorNameLength = strlen(&colorName[1]);
-
-        switch(colorNameLength)
-        {
-            case 3: // "#RGB"
-                b = ((word & 0x00F) >> 0) * 17;
-                g = ((word & 0x0F0) >> 4) * 17;
-                r = ((word & 0xF00) >> 8) * 17;
-                a = 255;
-                return;
-            case 4: // "#ARGB"
-                b = ((word & 0x000F) >> 0) * 17;
-                g = ((word & 0x00F0) >> 4) * 17;
-                r = ((word & 0x0F00) >> 8) * 17;
-                a = ((word & 0xF000) >> 12) * 17;
-                return;
-            case 6: // "#RRGGBB"
-                b = ((word & 0x0000FF) >> 0);
-                g = ((word & 0x00FF00) >> 8);
-                r = ((word & 0xFF0000) >> 16);
-                a = 255;
-                return;
-            case 8: // "#AARRGGBB"
-                /* A R G B */
-                b = ((word & 0x000000FF) >> 0);
-                g = ((word & 0x0000FF00) >> 8);
-                r = ((word & 0x00FF0000) >> 16);
-                a = ((word & 0xFF000000) >> 24);
-                return;
-            default: // parse error
-                r=0;
-                g=0;
-                b=0;
-                a=0;
-                return;
+// CSS named colors, lower case, and the constant each one stands for.
+#define NAMED_COLORS(X) \
+    X("transparent", Transparent) \
+    X("none", Transparent) \
+    \
+    /* Pink colors */ \
+    X("pink", Pink) \
+    X("lightpink", LightPink) \
+    X("hotpink", HotPink) \
+    X("deeppink", DeepPink) \
+    X("palevioletred", PaleVioletRed) \
+    X("mediumvioletred", MediumVioletRed) \
+    \
+    /* Red colors */ \
+    X("lightsalmon", LightSalmon) \
+    X("salmon", Salmon) \
+    X("darksalmon", DarkSalmon) \
+    X("lightcoral", LightCoral) \
+    X("indianred", IndianRed) \
+    X("crimson", Crimson) \
+    X("firebrick", FireBrick) \
+    X("darkred", DarkRed) \
+    X("red", Red) \
+    \
+    /* Orange colors */ \
+    X("orangered", OrangeRed) \
+    X("tomato", Tomato) \
+    X("coral", Coral) \
+    X("darkorange", DarkOrange) \
+    X("orange", Orange) \
+    \
+    /* Yellow colors */ \
+    X("yellow", Yellow) \
+    X("lightyellow", LightYellow) \
+    X("lemonchiffon", LemonChiffon) \
+    X("lightgoldenrodyellow", LightGoldenrodYellow) \
+    X("papayawhip", PapayaWhip) \
+    X("moccasin", Moccasin) \
+    X("peachpuff", PeachPuff) \
+    X("palegoldenrod", PaleGoldenrod) \
+    X("khaki", Khaki) \
+    X("darkkhaki", DarkKhaki) \
+    X("gold", Gold) \
+    \
+    /* Brown colors */ \
+    X("cornsilk", Cornsilk) \
+    X("blanchedalmond", BlanchedAlmond) \
+    X("bisque", Bisque) \
+    X("navajowhite", NavajoWhite) \
+    X("wheat", Wheat) \
+    X("burlywood", BurlyWood) \
+    X("tan", Tan) \
+    X("rosybrown", RosyBrown) \
+    X("sandybrown", SandyBrown) \
+    X("goldenrod", Goldenrod) \
+    X("darkgoldenrod", DarkGoldenrod) \
+    X("peru", Peru) \
+    X("chocolate", Chocolate) \
+    X("saddlebrown", SaddleBrown) \
+    X("sienna", Sienna) \
+    X("brown", Brown) \
+    X("maroon", Maroon) \
+    \
+    /* Green colors */ \
+    X("darkolivegreen", DarkOliveGreen) \
+    X("olive", Olive) \
+    X("olivedrab", OliveDrab) \
+    X("yellowgreen", YellowGreen) \
+    X("limegreen", LimeGreen) \
+    X("lime", Lime) \
+    X("lawngreen", LawnGreen) \
+    X("chartreuse", Chartreuse) \
+    X("greenyellow", GreenYellow) \
+    X("springgreen", SpringGreen) \
+    X("mediumspringgreen", MediumSpringGreen) \
+    X("lightgreen", LightGreen) \
+    X("palegreen", PaleGreen) \
+    X("darkseagreen", DarkSeaGreen) \
+    X("mediumseagreen", MediumSeaGreen) \
+    X("seagreen", SeaGreen) \
+    X("forestgreen", ForestGreen) \
+    X("green", Green) \
+    X("darkgreen", DarkGreen) \
+    \
+    /* Cyan colors */ \
+    X("mediumaquamarine", MediumAquamarine) \
+    X("aqua", Aqua) \
+    X("cyan", Cyan) \
+    X("lightcyan", LightCyan) \
+    X("paleturquoise", PaleTurquoise) \
+    X("aquamarine", Aquamarine) \
+    X("turquoise", Turquoise) \
+    X("mediumturquoise", MediumTurquoise) \
+    X("darkturquoise", DarkTurquoise) \
+    X("lightseagreen", LightSeaGreen) \
+    X("cadetblue", CadetBlue) \
+    X("darkcyan", DarkCyan) \
+    X("teal", Teal) \
+    \
+    /* Blue colors */ \
+    X("lightsteelblue", LightSteelBlue) \
+    X("powderblue", PowderBlue) \
+    X("lightblue", LightBlue) \
+    X("skyblue", SkyBlue) \
+    X("lightskyblue", LightSkyBlue) \
+    X("deepskyblue", DeepSkyBlue) \
+    X("dodgerblue", DodgerBlue) \
+    X("cornflowerblue", CornflowerBlue) \
+    X("steelblue", SteelBlue) \
+    X("royalblue", RoyalBlue) \
+    X("blue", Blue) \
+    X("mediumblue", MediumBlue) \
+    X("darkblue", DarkBlue) \
+    X("navy", Navy) \
+    X("midnightblue", MidnightBlue) \
+    \
+    /* Purple/Violet/Magenta colors */ \
+    X("lavender", Lavender) \
+    X("thistle", Thistle) \
+    X("plum", Plum) \
+    X("violet", Violet) \
+    X("orchid", Orchid) \
+    X("fuchsia", Fuchsia) \
+    X("magenta", Magenta) \
+    X("mediumorchid", MediumOrchid) \
+    X("mediumpurple", MediumPurple) \
+    X("blueviolet", BlueViolet) \
+    X("darkviolet", DarkViolet) \
+    X("darkorchid", DarkOrchid) \
+    X("darkmagenta", DarkMagenta) \
+    X("purple", Purple) \
+    X("indigo", Indigo) \
+    X("darkslateblue", DarkSlateBlue) \
+    X("rebeccapurple", RebeccaPurple) \
+    X("slateblue", SlateBlue) \
+    X("mediumslateblue", MediumSlateBlue) \
+    \
+    /* White colors */ \
+    X("white", White) \
+    X("snow", Snow) \
+    X("honeydew", Honeydew) \
+    X("mintcream", MintCream) \
+    X("azure", Azure) \
+    X("aliceblue", AliceBlue) \
+    X("ghostwhite", GhostWhite) \
+    X("whitesmoke", WhiteSmoke) \
+    X("seashell", Seashell) \
+    X("beige", Beige) \
+    X("oldlace", OldLace) \
+    X("floralwhite", FloralWhite) \
+    X("ivory", Ivory) \
+    X("antiquewhite", AntiqueWhite) \
+    X("linen", Linen) \
+    X("lavenderblush", LavenderBlush) \
+    X("mistyrose", MistyRose) \
+    \
+    /* Gray/Black colors */ \
+    X("gainsboro", Gainsboro) \
+    X("lightgrey", LightGrey) \
+    X("lightgray", LightGrey) \
+    X("silver", Silver) \
+    X("darkgray", DarkGray) \
+    X("darkgrey", DarkGray) \
+    X("gray", Gray) \
+    X("grey", Gray) \
+    X("dimgray", DimGray) \
+    X("dimgrey", DimGray) \
+    X("lightslategray", LightSlateGray) \
+    X("lightslategrey", LightSlateGray) \
+    X("slategray", SlateGray) \
+    X("slategrey", SlateGray) \
+    X("darkslategray", DarkSlateGray) \
+    X("darkslategrey", DarkSlateGray) \
+    X("black", Black)
+
+#define NAMED_COLOR_NAME(NAME, COLOR) NAME,
+#define NAMED_COLOR_VALUE(NAME, COLOR) &COLOR,
+
+static constexpr std::string_view namedColorNames[] = { NAMED_COLORS(NAMED_COLOR_NAME) };
+static const Color *const namedColorValues[] = { NAMED_COLORS(NAMED_COLOR_VALUE) };
+
+static constexpr size_t NAMED_COLOR_COUNT = sizeof(namedColorNames) / sizeof(namedColorNames[0]);
+static constexpr size_t MAX_NAMED_COLOR_SIZE = 20; // "lightgoldenrodyellow"
+
+static constexpr PerfectHash<NAMED_COLOR_COUNT, 4096> namedColors(namedColorNames);
+
+static inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+static inline char toLower(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+static inline int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c = toLower(c);
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+static inline uint8_t toByte(float value) {
+    return static_cast<uint8_t>(std::clamp(value, 0.0f, 255.0f) + 0.5f);
+}
+
+// 'digits' after the '#'.
+static bool parseHexColor(std::string_view digits, Color &color) {
+    uint32_t word = 0;
+    for (char c : digits) {
+        int digit = hexDigit(c);
+        if (digit < 0) {
+            return false;
         }
+        word = (word << 4) | static_cast<uint32_t>(digit);
+    }
+
+    switch (digits.size()) {
+        case 3: // "#RGB"
+            color.b = ((word & 0x00F) >> 0) * 17;
+            color.g = ((word & 0x0F0) >> 4) * 17;
+            color.r = ((word & 0xF00) >> 8) * 17;
+            color.a = 255;
+            return true;
+        case 4: // "#ARGB"
+            color.b = ((word & 0x000F) >> 0) * 17;
+            color.g = ((word & 0x00F0) >> 4) * 17;
+            color.r = ((word & 0x0F00) >> 8) * 17;
+            color.a = ((word & 0xF000) >> 12) * 17;
+            return true;
+        case 6: // "#RRGGBB"
+            color.b = ((word & 0x0000FF) >> 0);
+            color.g = ((word & 0x00FF00) >> 8);
+            color.r = ((word & 0xFF0000) >> 16);
+            color.a = 255;
+            return true;
+        case 8: // "#AARRGGBB"
+            color.b = ((word & 0x000000FF) >> 0);
+            color.g = ((word & 0x0000FF00) >> 8);
+            color.r = ((word & 0x00FF0000) >> 16);
+            color.a = ((word & 0xFF000000) >> 24);
+            return true;
+        default:
+            return false;
     }
-    else
-    {
-        uint32_t red, green, blue;
-        float alpha;
-
-        if (sscanf(colorName, "rgba(%u, %u, %u, %f)", &red, &green, &blue, &alpha) == 4)
-        {
-            r = static_cast<uint8_t>(red);
-            g = static_cast<uint8_t>(green);
-            b = static_cast<uint8_t>(blue);
-            a = static_cast<uint8_t>(alpha / 255.0f);
-            return;
+}
+
+// Arguments of rgb(), rgba(), hsl() and hsla(), up to the closing
+// parenthesis. Separated by commas, or by spaces with a '/' before the alpha
+// as CSS Color 4 allows. Hues can have a "deg" unit.
+struct ColorArguments {
+    float values[4];
+    bool percent[4];
+    int count = 0;
+};
+
+static bool parseColorArguments(const char *cur, const char *end, ColorArguments &arguments) {
+    for (;;) {
+        while (cur < end && isSpace(*cur)) ++cur;
+        if (cur < end && *cur == ')') {
+            ++cur;
+            break;
+        }
+        if (arguments.count == 4) {
+            return false;
+        }
+        if (arguments.count > 0 && cur < end && (*cur == ',' || *cur == '/')) {
+            ++cur;
+            while (cur < end && isSpace(*cur)) ++cur;
+        }
+
+        float value;
+        if (!parseNumber(cur, end, value)) {
+            return false;
         }
+        bool percent = cur < end && *cur == '%';
+        if (percent) {
+            ++cur;
+        } else if (end - cur >= 3 && toLower(cur[0]) == 'd' && toLower(cur[1]) == 'e' && toLower(cur[2]) == 'g') {
+            cur += 3;
+        }
+        arguments.values[arguments.count] = value;
+        arguments.percent[arguments.count] = percent;
+        ++arguments.count;
+    }
+
+    while (cur < end && isSpace(*cur)) ++cur;
+    return cur == end && arguments.count >= 3;
+}
+
+// 0..1, from a number or a percentage.
+static inline float alphaArgument(const ColorArguments &arguments) {
+    if (arguments.count < 4) {
+        return 1.0f;
+    }
+    float alpha = arguments.percent[3] ? arguments.values[3] / 100.0f : arguments.values[3];
+    return std::clamp(alpha, 0.0f, 1.0f);
+}
+
+static void rgbColor(const ColorArguments &arguments, Color &color) {
+    for (int i = 0; i < 3; ++i) {
+        color[i] = toByte(arguments.percent[i] ? arguments.values[i] * 2.55f : arguments.values[i]);
+    }
+    color.a = toByte(alphaArgument(arguments) * 255.0f);
+}
+
+static void hslColor(const ColorArguments &arguments, Color &color) {
+    float hue = std::fmod(arguments.values[0], 360.0f);
+    if (hue < 0.0f) {
+        hue += 360.0f;
+    }
+    float saturation = std::clamp(arguments.values[1] / 100.0f, 0.0f, 1.0f);
+    float lightness = std::clamp(arguments.values[2] / 100.0f, 0.0f, 1.0f);
+
+    // CSS Color 4, hslToRgb()
+    float chroma = (1.0f - std::fabs(2.0f * lightness - 1.0f)) * saturation;
+    for (int i = 0; i < 3; ++i) {
+        static const float offsets[3] = {0.0f, 8.0f, 4.0f};
+        float k = std::fmod(offsets[i] + hue / 30.0f, 12.0f);
+        float value = lightness - chroma * 0.5f * std::clamp(std::min(k - 3.0f, 9.0f - k), -1.0f, 1.0f);
+        color[i] = toByte(value * 255.0f);
+    }
+    color.a = toByte(alphaArgument(arguments) * 255.0f);
+}
 
-        if (sscanf(colorName, "rgb(%u, %u, %u)", &red, &green, &blue) == 3)
-        {
-            r = static_cast<uint8_t>(red);
-            g = static_cast<uint8_t>(green);
-            b = static_cast<uint8_t>(blue);
-            a = 255;
-            return;
+bool Color::parse(std::string_view value, Color &color) {
+    while (!value.empty() && isSpace(value.front())) value.remove_prefix(1);
+    while (!value.empty() && isSpace(value.back())) value.remove_suffix(1);
+    if (value.empty()) {
+        return false;
+    }
+
+    if (value[0] == '#') {
+        return parseHexColor(value.substr(1), color);
+    }
+
+    // case insensitive, like the rest of CSS
+    char lowerCase[MAX_NAMED_COLOR_SIZE];
+    size_t nameSize = 0;
+    for (; nameSize < value.size() && value[nameSize] != '('; ++nameSize) {
+        if (nameSize == MAX_NAMED_COLOR_SIZE) {
+            return false;
         }
+        lowerCase[nameSize] = toLower(value[nameSize]);
+    }
+    std::string_view name(lowerCase, nameSize);
 
-        // none means 'Transparent'
-        if (strcasecmp(colorName, "none") == 0) { 
-            r=0;
-            g=0;
-            b=0;
-            a=0;
-            return;
+    if (nameSize == value.size()) {
+        size_t index = namedColors.find(name);
+        if (index == namedColors.notFound) {
+            return false;
         }
+        color = *namedColorValues[index];
+        return true;
+    }
+
+    bool rgb = name == "rgb" || name == "rgba";
+    bool hsl = name == "hsl" || name == "hsla";
+    ColorArguments arguments;
+    if (!(rgb || hsl) || value.back() != ')' || !parseColorArguments(value.data() + nameSize + 1, value.data() + value.size(), arguments)) {
+        return false;
+    }
+    if (rgb) {
+        rgbColor(arguments, color);
+    } else {
+        hslColor(arguments, color);
     }
+    return true;
+}
 
-    #define RETURN_IF_MATCH(COLOR_NAME) do { if(strcasecmp(colorName, #COLOR_NAME) == 0) { r=COLOR_NAME.r; g=COLOR_NAME.g; b=COLOR_NAME.b; a=COLOR_NAME.a;  return; } } while((void)0, 0)
-
-    RETURN_IF_MATCH(Transparent);
-
-    /* Pink colors */
-    RETURN_IF_MATCH(Pink);
-    RETURN_IF_MATCH(LightPink);
-    RETURN_IF_MATCH(HotPink);
-    RETURN_IF_MATCH(DeepPink);
-    RETURN_IF_MATCH(PaleVioletRed);
-    RETURN_IF_MATCH(MediumVioletRed);
-
-    /* Red colors */
-    RETURN_IF_MATCH(LightSalmon);
-    RETURN_IF_MATCH(Salmon);
-    RETURN_IF_MATCH(DarkSalmon);
-    RETURN_IF_MATCH(LightCoral);
-    RETURN_IF_MATCH(IndianRed);
-    RETURN_IF_MATCH(Crimson);
-    RETURN_IF_MATCH(FireBrick);
-    RETURN_IF_MATCH(DarkRed);
-    RETURN_IF_MATCH(Red);
-
-    /* Orange colors */
-    RETURN_IF_MATCH(OrangeRed);
-    RETURN_IF_MATCH(Tomato);
-    RETURN_IF_MATCH(Coral);
-    RETURN_IF_MATCH(DarkOrange);
-    RETURN_IF_MATCH(Orange);
-
-    /* Yellow colors */
-    RETURN_IF_MATCH(Yellow);
-    RETURN_IF_MATCH(LightYellow);
-    RETURN_IF_MATCH(LemonChiffon);
-    RETURN_IF_MATCH(LightGoldenrodYellow);
-    RETURN_IF_MATCH(PapayaWhip);
-    RETURN_IF_MATCH(Moccasin);
-    RETURN_IF_MATCH(PeachPuff);
-    RETURN_IF_MATCH(PaleGoldenrod);
-    RETURN_IF_MATCH(Khaki);
-    RETURN_IF_MATCH(DarkKhaki);
-    RETURN_IF_MATCH(Gold);
-
-    /* Brown colors */
-    RETURN_IF_MATCH(Cornsilk);
-    RETURN_IF_MATCH(BlanchedAlmond);
-    RETURN_IF_MATCH(Bisque);
-    RETURN_IF_MATCH(NavajoWhite);
-    RETURN_IF_MATCH(Wheat);
-    RETURN_IF_MATCH(BurlyWood);
-    RETURN_IF_MATCH(Tan);
-    RETURN_IF_MATCH(RosyBrown);
-    RETURN_IF_MATCH(SandyBrown);
-    RETURN_IF_MATCH(Goldenrod);
-    RETURN_IF_MATCH(DarkGoldenrod);
-    RETURN_IF_MATCH(Peru);
-    RETURN_IF_MATCH(Chocolate);
-    RETURN_IF_MATCH(SaddleBrown);
-    RETURN_IF_MATCH(Sienna);
-    RETURN_IF_MATCH(Brown);
-    RETURN_IF_MATCH(Maroon);
-
-    /* Green colors */
-    RETURN_IF_MATCH(DarkOliveGreen);
-    RETURN_IF_MATCH(Olive);
-    RETURN_IF_MATCH(OliveDrab);
-    RETURN_IF_MATCH(YellowGreen);
-    RETURN_IF_MATCH(LimeGreen);
-    RETURN_IF_MATCH(Lime);
-    RETURN_IF_MATCH(LawnGreen);
-    RETURN_IF_MATCH(Chartreuse);
-    RETURN_IF_MATCH(GreenYellow);
-    RETURN_IF_MATCH(SpringGreen);
-    RETURN_IF_MATCH(MediumSpringGreen);
-    RETURN_IF_MATCH(LightGreen);
-    RETURN_IF_MATCH(PaleGreen);
-    RETURN_IF_MATCH(DarkSeaGreen);
-    RETURN_IF_MATCH(MediumSeaGreen);
-    RETURN_IF_MATCH(SeaGreen);
-    RETURN_IF_MATCH(ForestGreen);
-    RETURN_IF_MATCH(Green);
-    RETURN_IF_MATCH(DarkGreen);
-
-    /* Cyan colors */
-    RETURN_IF_MATCH(MediumAquamarine);
-    RETURN_IF_MATCH(Aqua);
-    RETURN_IF_MATCH(Cyan);
-    RETURN_IF_MATCH(LightCyan);
-    RETURN_IF_MATCH(PaleTurquoise);
-    RETURN_IF_MATCH(Aquamarine);
-    RETURN_IF_MATCH(Turquoise);
-    RETURN_IF_MATCH(MediumTurquoise);
-    RETURN_IF_MATCH(DarkTurquoise);
-    RETURN_IF_MATCH(LightSeaGreen);
-    RETURN_IF_MATCH(CadetBlue);
-    RETURN_IF_MATCH(DarkCyan);
-    RETURN_IF_MATCH(Teal);
-
-    /* Blue colors */
-    RETURN_IF_MATCH(LightSteelBlue);
-    RETURN_IF_MATCH(PowderBlue);
-    RETURN_IF_MATCH(LightBlue);
-    RETURN_IF_MATCH(SkyBlue);
-    RETURN_IF_MATCH(LightSkyBlue);
-    RETURN_IF_MATCH(DeepSkyBlue);
-    RETURN_IF_MATCH(DodgerBlue);
-    RETURN_IF_MATCH(CornflowerBlue);
-    RETURN_IF_MATCH(SteelBlue);
-    RETURN_IF_MATCH(RoyalBlue);
-    RETURN_IF_MATCH(Blue);
-    RETURN_IF_MATCH(MediumBlue);
-    RETURN_IF_MATCH(DarkBlue);
-    RETURN_IF_MATCH(Navy);
-    RETURN_IF_MATCH(MidnightBlue);
-
-    /* Purple/Violet/Magenta colors */
-    RETURN_IF_MATCH(Lavender);
-    RETURN_IF_MATCH(Thistle);
-    RETURN_IF_MATCH(Plum);
-    RETURN_IF_MATCH(Violet);
-    RETURN_IF_MATCH(Orchid);
-    RETURN_IF_MATCH(Fuchsia);
-    RETURN_IF_MATCH(Magenta);
-    RETURN_IF_MATCH(MediumOrchid);
-    RETURN_IF_MATCH(MediumPurple);
-    RETURN_IF_MATCH(BlueViolet);
-    RETURN_IF_MATCH(DarkViolet);
-    RETURN_IF_MATCH(DarkOrchid);
-    RETURN_IF_MATCH(DarkMagenta);
-    RETURN_IF_MATCH(Purple);
-    RETURN_IF_MATCH(Indigo);
-    RETURN_IF_MATCH(DarkSlateBlue);
-    RETURN_IF_MATCH(RebeccaPurple);
-    RETURN_IF_MATCH(SlateBlue);
-    RETURN_IF_MATCH(MediumSlateBlue);
-
-    /* White colors */
-    RETURN_IF_MATCH(White);
-    RETURN_IF_MATCH(Snow);
-    RETURN_IF_MATCH(Honeydew);
-    RETURN_IF_MATCH(MintCream);
-    RETURN_IF_MATCH(Azure);
-    RETURN_IF_MATCH(AliceBlue);
-    RETURN_IF_MATCH(GhostWhite);
-    RETURN_IF_MATCH(WhiteSmoke);
-    RETURN_IF_MATCH(Seashell);
-    RETURN_IF_MATCH(Beige);
-    RETURN_IF_MATCH(OldLace);
-    RETURN_IF_MATCH(FloralWhite);
-    RETURN_IF_MATCH(Ivory);
-    RETURN_IF_MATCH(AntiqueWhite);
-    RETURN_IF_MATCH(Linen);
-    RETURN_IF_MATCH(LavenderBlush);
-    RETURN_IF_MATCH(MistyRose);
-
-    /* Gray/Black colors */
-    RETURN_IF_MATCH(Gainsboro);
-    RETURN_IF_MATCH(LightGrey);
-    RETURN_IF_MATCH(Silver);
-    RETURN_IF_MATCH(DarkGray);
-    RETURN_IF_MATCH(Gray);
-    RETURN_IF_MATCH(DimGray);
-    RETURN_IF_MATCH(LightSlateGray);
-    RETURN_IF_MATCH(SlateGray);
-    RETURN_IF_MATCH(DarkSlateGray);
-    RETURN_IF_MATCH(Black);
-
-    r=0;
-    g=0;
-    b=0;
-    a=0;
+Color::Color(const char* colorName) : Color(std::string_view(colorName))
+{
+}
+
+Color::Color(std::string_view colorName) : glm::u8vec4(0, 0, 0, 0)
+{
+    // anything else, "url(#gradient)" included, is transparent.
+    if (!parse(colorName, *this)) {
+        r=0;
+        g=0;
+        b=0;
+        a=0;
+    }
 }
@@ -1,6 +1,8 @@
 #ifndef COLOR_H
 #define COLOR_H
 
+#include <string_view>
+
 #include <glm/fwd.hpp>
 #include <glm/vec4.hpp>
 
@@ -11,7 +13,15 @@ public:
     Color() : glm::u8vec4() {}
     Color(uint32_t rgba) : glm::u8vec4((rgba >> 0) & 0xff, (rgba >> 8) & 0xff, (rgba >> 16) & 0xff, (rgba >> 24) & 0xff) {} // WARNING: Only works for low endian CPU (armv8a, x86-64, etc)
     Color(uint8_t r, uint8_t g, uint8_t b, float a = 1.0f) : glm::u8vec4(r, g, b, a*255) {}
+    // CSS color: "#RGB", "#ARGB", "#RRGGBB", "#AARRGGBB", rgb(), rgba(),
+    // hsl(), hsla() or a named color, case insensitive. Transparent if it
+    // can't be parsed.
     Color(const char* colorName);
+    Color(std::string_view colorName);
+
+    // Same, returning false and leaving 'color' as it is if 'value' can't be
+    // parsed. Doesn't allocate.
+    static bool parse(std::string_view value, Color &color);
 };
 
 inline Color rgb(uint8_t r, uint8_t g, uint8_t b)
@@ -0,0 +1,292 @@
+#include "CurveBatch.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CURVE_BATCH_SSE2
+#include <emmintrin.h>
+#endif
+
+// AVX2 is compiled in with a target attribute and picked at runtime, so the
+// binaries still run on CPUs without it. MSVC builds stick to SSE2.
+#if defined(CURVE_BATCH_SSE2) && (defined(__GNUC__) || defined(__clang__)) && !defined(__EMSCRIPTEN__)
+#define CURVE_BATCH_AVX2
+#include <immintrin.h>
+#define CURVE_BATCH_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+// the vector loops store whole registers, so the output arrays are over
+// allocated by one register worth of floats.
+static constexpr size_t LANE_PADDING = 8;
+
+namespace
+{
+    // Wang's formula, see detail::cubicSegmentCount() in VectorGraphic.cpp.
+    inline uint32_t segmentCountScalar(const CurveBatch &batch, size_t i, float distanceTolerance, float segmentLimit)
+    {
+        float ddx0 = batch.x0[i] - 2.0f * batch.x1[i] + batch.x2[i];
+        float ddy0 = batch.y0[i] - 2.0f * batch.y1[i] + batch.y2[i];
+        float ddx1 = batch.x1[i] - 2.0f * batch.x2[i] + batch.x3[i];
+        float ddy1 = batch.y1[i] - 2.0f * batch.y2[i] + batch.y3[i];
+        float dd = std::sqrt(std::max(ddx0 * ddx0 + ddy0 * ddy0, ddx1 * ddx1 + ddy1 * ddy1));
+
+        // NaNs (e.g. from infinite control points) give 1, like _mm_max_ps()
+        // does in the vector loops, rather than an undefined conversion.
+        float segmentCount = std::ceil(std::sqrt(0.75f * dd / distanceTolerance));
+        return static_cast<uint32_t>(!(segmentCount >= 1.0f) ? 1.0f : std::min(segmentCount, segmentLimit));
+    }
+
+    void segmentCountsScalar(CurveBatch &batch, size_t begin, float distanceTolerance, float segmentLimit)
+    {
+        for (size_t i = begin; i < batch.size(); ++i)
+        {
+            batch.segmentCount[i] = segmentCountScalar(batch, i, distanceTolerance, segmentLimit);
+        }
+    }
+
+#ifndef CURVE_BATCH_SSE2
+    // B(t) = ((a*t + b)*t + c)*t + p0, evaluated for t = j/n with j in [1, n).
+    void evaluateScalar(CurveBatch &batch, size_t i)
+    {
+        uint32_t segmentCount = batch.segmentCount[i];
+        float h = 1.0f / static_cast<float>(segmentCount);
+
+        float ax = -batch.x0[i] + 3.0f * (batch.x1[i] - batch.x2[i]) + batch.x3[i];
+        float ay = -batch.y0[i] + 3.0f * (batch.y1[i] - batch.y2[i]) + batch.y3[i];
+        float bx = 3.0f * (batch.x0[i] - 2.0f * batch.x1[i] + batch.x2[i]);
+        float by = 3.0f * (batch.y0[i] - 2.0f * batch.y1[i] + batch.y2[i]);
+        float cx = 3.0f * (batch.x1[i] - batch.x0[i]);
+        float cy = 3.0f * (batch.y1[i] - batch.y0[i]);
+
+        float *outX = batch.pointsX.data() + batch.firstPoint[i];
+        float *outY = batch.pointsY.data() + batch.firstPoint[i];
+        for (uint32_t j = 1; j < segmentCount; ++j)
+        {
+            float t = static_cast<float>(j) * h;
+            outX[j - 1] = ((ax * t + bx) * t + cx) * t + batch.x0[i];
+            outY[j - 1] = ((ay * t + by) * t + cy) * t + batch.y0[i];
+        }
+    }
+#endif
+
+#ifdef CURVE_BATCH_SSE2
+    // 4 curves at a time.
+    size_t segmentCountsSSE2(CurveBatch &batch, float distanceTolerance, float segmentLimit)
+    {
+        const __m128 two = _mm_set1_ps(2.0f);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 limit = _mm_set1_ps(segmentLimit);
+        const __m128 scale = _mm_set1_ps(0.75f);
+        const __m128 tolerance = _mm_set1_ps(distanceTolerance);
+
+        size_t i = 0;
+        for (; i + 4 <= batch.size(); i += 4)
+        {
+            __m128 x0 = _mm_loadu_ps(&batch.x0[i]);
+            __m128 y0 = _mm_loadu_ps(&batch.y0[i]);
+            __m128 x1 = _mm_loadu_ps(&batch.x1[i]);
+            __m128 y1 = _mm_loadu_ps(&batch.y1[i]);
+            __m128 x2 = _mm_loadu_ps(&batch.x2[i]);
+            __m128 y2 = _mm_loadu_ps(&batch.y2[i]);
+            __m128 x3 = _mm_loadu_ps(&batch.x3[i]);
+            __m128 y3 = _mm_loadu_ps(&batch.y3[i]);
+
+            __m128 ddx0 = _mm_add_ps(_mm_sub_ps(x0, _mm_mul_ps(two, x1)), x2);
+            __m128 ddy0 = _mm_add_ps(_mm_sub_ps(y0, _mm_mul_ps(two, y1)), y2);
+            __m128 ddx1 = _mm_add_ps(_mm_sub_ps(x1, _mm_mul_ps(two, x2)), x3);
+            __m128 ddy1 = _mm_add_ps(_mm_sub_ps(y1, _mm_mul_ps(two, y2)), y3);
+            __m128 dd0 = _mm_add_ps(_mm_mul_ps(ddx0, ddx0), _mm_mul_ps(ddy0, ddy0));
+            __m128 dd1 = _mm_add_ps(_mm_mul_ps(ddx1, ddx1), _mm_mul_ps(ddy1, ddy1));
+            __m128 dd = _mm_sqrt_ps(_mm_max_ps(dd0, dd1));
+
+            // clamping before rounding up gives the same result since both
+            // bounds are integers. _mm_max_ps() also turns NaNs into 1.
+            __m128 n = _mm_sqrt_ps(_mm_div_ps(_mm_mul_ps(scale, dd), tolerance));
+            n = _mm_min_ps(_mm_max_ps(n, one), limit);
+
+            // SSE2 has no ceil, truncate and bump the lanes that were rounded down.
+            __m128i truncated = _mm_cvttps_epi32(n);
+            __m128 roundedDown = _mm_cmplt_ps(_mm_cvtepi32_ps(truncated), n);
+            truncated = _mm_sub_epi32(truncated, _mm_castps_si128(roundedDown));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(&batch.segmentCount[i]), truncated);
+        }
+        return i;
+    }
+
+    // 4 points of the same curve at a time.
+    void evaluateSSE2(CurveBatch &batch, size_t i)
+    {
+        uint32_t segmentCount = batch.segmentCount[i];
+        float h = 1.0f / static_cast<float>(segmentCount);
+
+        __m128 ax = _mm_set1_ps(-batch.x0[i] + 3.0f * (batch.x1[i] - batch.x2[i]) + batch.x3[i]);
+        __m128 ay = _mm_set1_ps(-batch.y0[i] + 3.0f * (batch.y1[i] - batch.y2[i]) + batch.y3[i]);
+        __m128 bx = _mm_set1_ps(3.0f * (batch.x0[i] - 2.0f * batch.x1[i] + batch.x2[i]));
+        __m128 by = _mm_set1_ps(3.0f * (batch.y0[i] - 2.0f * batch.y1[i] + batch.y2[i]));
+        __m128 cx = _mm_set1_ps(3.0f * (batch.x1[i] - batch.x0[i]));
+        __m128 cy = _mm_set1_ps(3.0f * (batch.y1[i] - batch.y0[i]));
+        __m128 dx = _mm_set1_ps(batch.x0[i]);
+        __m128 dy = _mm_set1_ps(batch.y0[i]);
+
+        const __m128 lanes = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+        const __m128 step = _mm_set1_ps(h);
+
+        float *outX = batch.pointsX.data() + batch.firstPoint[i];
+        float *outY = batch.pointsY.data() + batch.firstPoint[i];
+        for (uint32_t j = 1; j < segmentCount; j += 4)
+        {
+            __m128 t = _mm_mul_ps(_mm_add_ps(_mm_set1_ps(static_cast<float>(j)), lanes), step);
+            __m128 x = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(ax, t), bx), t), cx), t), dx);
+            __m128 y = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(ay, t), by), t), cy), t), dy);
+            _mm_storeu_ps(outX + j - 1, x);
+            _mm_storeu_ps(outY + j - 1, y);
+        }
+    }
+#endif
+
+#ifdef CURVE_BATCH_AVX2
+    bool hasAVX2()
+    {
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+    }
+
+    // 8 curves at a time.
+    CURVE_BATCH_TARGET_AVX2 size_t segmentCountsAVX2(CurveBatch &batch, float distanceTolerance, float segmentLimit)
+    {
+        const __m256 two = _mm256_set1_ps(2.0f);
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 limit = _mm256_set1_ps(segmentLimit);
+        const __m256 scale = _mm256_set1_ps(0.75f);
+        const __m256 tolerance = _mm256_set1_ps(distanceTolerance);
+
+        size_t i = 0;
+        for (; i + 8 <= batch.size(); i += 8)
+        {
+            __m256 x0 = _mm256_loadu_ps(&batch.x0[i]);
+            __m256 y0 = _mm256_loadu_ps(&batch.y0[i]);
+            __m256 x1 = _mm256_loadu_ps(&batch.x1[i]);
+            __m256 y1 = _mm256_loadu_ps(&batch.y1[i]);
+            __m256 x2 = _mm256_loadu_ps(&batch.x2[i]);
+            __m256 y2 = _mm256_loadu_ps(&batch.y2[i]);
+            __m256 x3 = _mm256_loadu_ps(&batch.x3[i]);
+            __m256 y3 = _mm256_loadu_ps(&batch.y3[i]);
+
+            __m256 ddx0 = _mm256_add_ps(_mm256_sub_ps(x0, _mm256_mul_ps(two, x1)), x2);
+            __m256 ddy0 = _mm256_add_ps(_mm256_sub_ps(y0, _mm256_mul_ps(two, y1)), y2);
+            __m256 ddx1 = _mm256_add_ps(_mm256_sub_ps(x1, _mm256_mul_ps(two, x2)), x3);
+            __m256 ddy1 = _mm256_add_ps(_mm256_sub_ps(y1, _mm256_mul_ps(two, y2)), y3);
+            __m256 dd0 = _mm256_add_ps(_mm256_mul_ps(ddx0, ddx0), _mm256_mul_ps(ddy0, ddy0));
+            __m256 dd1 = _mm256_add_ps(_mm256_mul_ps(ddx1, ddx1), _mm256_mul_ps(ddy1, ddy1));
+            __m256 dd = _mm256_sqrt_ps(_mm256_max_ps(dd0, dd1));
+
+            __m256 n = _mm256_sqrt_ps(_mm256_div_ps(_mm256_mul_ps(scale, dd), tolerance));
+            n = _mm256_ceil_ps(_mm256_min_ps(_mm256_max_ps(n, one), limit));
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(&batch.segmentCount[i]), _mm256_cvttps_epi32(n));
+        }
+        return i;
+    }
+
+    // 8 points of the same curve at a time.
+    CURVE_BATCH_TARGET_AVX2 void evaluateAVX2(CurveBatch &batch, size_t i)
+    {
+        uint32_t segmentCount = batch.segmentCount[i];
+        float h = 1.0f / static_cast<float>(segmentCount);
+
+        __m256 ax = _mm256_set1_ps(-batch.x0[i] + 3.0f * (batch.x1[i] - batch.x2[i]) + batch.x3[i]);
+        __m256 ay = _mm256_set1_ps(-batch.y0[i] + 3.0f * (batch.y1[i] - batch.y2[i]) + batch.y3[i]);
+        __m256 bx = _mm256_set1_ps(3.0f * (batch.x0[i] - 2.0f * batch.x1[i] + batch.x2[i]));
+        __m256 by = _mm256_set1_ps(3.0f * (batch.y0[i] - 2.0f * batch.y1[i] + batch.y2[i]));
+        __m256 cx = _mm256_set1_ps(3.0f * (batch.x1[i] - batch.x0[i]));
+        __m256 cy = _mm256_set1_ps(3.0f * (batch.y1[i] - batch.y0[i]));
+        __m256 dx = _mm256_set1_ps(batch.x0[i]);
+        __m256 dy = _mm256_set1_ps(batch.y0[i]);
+
+        const __m256 lanes = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+        const __m256 step = _mm256_set1_ps(h);
+
+        float *outX = batch.pointsX.data() + batch.firstPoint[i];
+        float *outY = batch.pointsY.data() + batch.firstPoint[i];
+        for (uint32_t j = 1; j < segmentCount; j += 8)
+        {
+            __m256 t = _mm256_mul_ps(_mm256_add_ps(_mm256_set1_ps(static_cast<float>(j)), lanes), step);
+            __m256 x = _mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(ax, t), bx), t), cx), t), dx);
+            __m256 y = _mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(ay, t), by), t), cy), t), dy);
+            _mm256_storeu_ps(outX + j - 1, x);
+            _mm256_storeu_ps(outY + j - 1, y);
+        }
+    }
+#endif
+}
+
+void CurveBatch::flatten(const std::vector<PendingCurve> &curves, float distanceTolerance, uint32_t segmentLimit)
+{
+    const size_t count = curves.size();
+    const float limit = static_cast<float>(segmentLimit);
+
+    // resize() keeps the capacity from the previous paths.
+    x0.resize(count);
+    y0.resize(count);
+    x1.resize(count);
+    y1.resize(count);
+    x2.resize(count);
+    y2.resize(count);
+    x3.resize(count);
+    y3.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const PendingCurve &curve = curves[i];
+        x0[i] = curve.p0.x;
+        y0[i] = curve.p0.y;
+        x1[i] = curve.p1.x;
+        y1[i] = curve.p1.y;
+        x2[i] = curve.p2.x;
+        y2[i] = curve.p2.y;
+        x3[i] = curve.p3.x;
+        y3[i] = curve.p3.y;
+    }
+
+    segmentCount.resize(count);
+
+    size_t i = 0;
+#if defined(CURVE_BATCH_AVX2)
+    i = hasAVX2() ? segmentCountsAVX2(*this, distanceTolerance, limit) : segmentCountsSSE2(*this, distanceTolerance, limit);
+#elif defined(CURVE_BATCH_SSE2)
+    i = segmentCountsSSE2(*this, distanceTolerance, limit);
+#endif
+    segmentCountsScalar(*this, i, distanceTolerance, limit);
+
+    // a curve split in n segments has n-1 interior points.
+    firstPoint.resize(count + 1);
+    uint32_t pointCount = 0;
+    for (i = 0; i < count; ++i)
+    {
+        firstPoint[i] = pointCount;
+        pointCount += segmentCount[i] - 1;
+    }
+    firstPoint[count] = pointCount;
+
+    pointsX.resize(pointCount + LANE_PADDING);
+    pointsY.resize(pointCount + LANE_PADDING);
+
+    // the curves must be evaluated in order: the padding lanes of a curve
+    // spill into the next curve's points, which then get overwritten.
+#if defined(CURVE_BATCH_AVX2)
+    if (hasAVX2())
+    {
+        for (i = 0; i < count; ++i) evaluateAVX2(*this, i);
+        return;
+    }
+#endif
+    for (i = 0; i < count; ++i)
+    {
+#ifdef CURVE_BATCH_SSE2
+        evaluateSSE2(*this, i);
+#else
+        evaluateScalar(*this, i);
+#endif
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef CURVE_BATCH_H
+#define CURVE_BATCH_H
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+// A cubic bezier recorded by Path2D while CurveFlattener::batched is in use.
+struct PendingCurve
+{
+    glm::vec2 p0, p1, p2, p3;
+
+    // where the curve goes: the index of its subpath, and the index of its end
+    // point in that subpath. The end point is added right away, the interior
+    // points get inserted in front of it once the batch has been flattened.
+    uint32_t subPathIndex;
+    uint32_t pointIndex;
+};
+
+// Cubic bezier curves flattened together. The control points are stored as a
+// structure of arrays so the segment counts and the points can be computed 4
+// (SSE2) or 8 (AVX2) lanes at a time. Meant to be reused from one path to the
+// next (see current()) so its arrays only grow once.
+struct CurveBatch
+{
+    // control points, one array per coordinate.
+    std::vector<float> x0, y0, x1, y1, x2, y2, x3, y3;
+
+    // flatten() results. The interior points of curve i are
+    // [firstPoint[i], firstPoint[i+1]) in pointsX and pointsY.
+    std::vector<uint32_t> segmentCount;
+    std::vector<uint32_t> firstPoint;
+    std::vector<float> pointsX;
+    std::vector<float> pointsY;
+
+    inline size_t size() const {
+        return x0.size();
+    }
+
+    // replaces the content of the batch with 'curves' and flattens them.
+    void flatten(const std::vector<PendingCurve> &curves, float distanceTolerance, uint32_t segmentLimit);
+
+    // batch of the calling thread.
+    static inline CurveBatch &current() {
+        static thread_local CurveBatch batch;
+        return batch;
+    }
+};
+
+#endif // CURVE_BATCH_H
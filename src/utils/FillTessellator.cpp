@@ -0,0 +1,196 @@
+#include "FillTessellator.h"
+
+#include <algorithm>
+
+void FillTessellator::addContour(const std::vector<ContourPoint> &points) {
+    // we need at least 3 points to make a shape, the edges of anything less
+    // cancel each other out.
+    if (points.size() < 3) {
+        return;
+    }
+
+    uint32_t firstPoint = static_cast<uint32_t>(pointVertices.size());
+    pointVertices.resize(pointVertices.size() + points.size());
+
+    for (size_t i = 0; i < points.size(); ++i) {
+        size_t j = i+1 < points.size() ? i+1 : 0;
+        glm::vec2 a = points[i].pos;
+        glm::vec2 b = points[j].pos;
+        uint32_t aPoint = firstPoint + static_cast<uint32_t>(i);
+        uint32_t bPoint = firstPoint + static_cast<uint32_t>(j);
+
+        // horizontal edges don't cross any scanbeam.
+        if (a.y == b.y) {
+            continue;
+        }
+
+        int32_t winding = 1;
+        if (a.y > b.y) {
+            std::swap(a, b);
+            std::swap(aPoint, bPoint);
+            winding = -1;
+        }
+
+        edges.push_back({a.x, a.y, b.x, b.y, (b.x - a.x) / (b.y - a.y), winding, aPoint, bPoint, 0.0f, UINT32_MAX});
+        scanlines.push_back(a.y);
+        scanlines.push_back(b.y);
+    }
+}
+
+void FillTessellator::tessellate(Mesh &mesh, const Color &color, FillRule fillRule) {
+    std::fill(pointVertices.begin(), pointVertices.end(), UINT32_MAX);
+    activeEdges.clear();
+    openSpans.clear();
+
+    std::sort(edges.begin(), edges.end(), [](const Edge &a, const Edge &b) { return a.y0 < b.y0; });
+    std::sort(scanlines.begin(), scanlines.end());
+    scanlines.erase(std::unique(scanlines.begin(), scanlines.end()), scanlines.end());
+
+    auto inside = [fillRule](int32_t winding) {
+        return fillRule == FillRule::evenOdd ? (winding & 1) != 0 : winding != 0;
+    };
+
+    size_t nextEdge = 0;
+    size_t nextScanline = 1;
+    float y = scanlines.empty() ? 0.0f : scanlines[0];
+
+    while (nextScanline < scanlines.size()) {
+        float yBottom = scanlines[nextScanline];
+
+        // update the edges crossing the scanbeam
+        while (nextEdge < edges.size() && edges[nextEdge].y0 <= y) {
+            activeEdges.push_back(static_cast<uint32_t>(nextEdge++));
+        }
+        activeEdges.erase(std::remove_if(activeEdges.begin(), activeEdges.end(), [this, y](uint32_t edge) {
+            return edges[edge].y1 <= y;
+        }), activeEdges.end());
+
+        beamEdges.clear();
+        for (uint32_t edge : activeEdges) {
+            beamEdges.push_back({edge, edges[edge].xAt(y), edges[edge].xAt(yBottom)});
+        }
+        std::sort(beamEdges.begin(), beamEdges.end(), [](const BeamEdge &a, const BeamEdge &b) {
+            return a.xTop < b.xTop || (a.xTop == b.xTop && a.xBottom < b.xBottom);
+        });
+
+        // Edges that swap places within the scanbeam intersect. The first
+        // intersection is between neighbours, split the scanbeam there so the
+        // edges are in order in both halves.
+        float yCross = yBottom;
+        for (size_t i = 0; i + 1 < beamEdges.size(); ++i) {
+            const BeamEdge &a = beamEdges[i];
+            const BeamEdge &b = beamEdges[i+1];
+            if (a.xBottom > b.xBottom) {
+                float topGap = b.xTop - a.xTop;
+                float bottomGap = a.xBottom - b.xBottom;
+                float yIntersection = y + (yBottom - y) * (topGap / (topGap + bottomGap));
+                if (yIntersection > y && yIntersection < yCross) {
+                    yCross = yIntersection;
+                }
+            }
+        }
+        if (yCross < yBottom) {
+            yBottom = yCross;
+            for (BeamEdge &beamEdge : beamEdges) {
+                beamEdge.xBottom = edges[beamEdge.edge].xAt(yBottom);
+            }
+        }
+
+        // inside spans of the scanbeam
+        spans.clear();
+        int32_t winding = 0;
+        const BeamEdge *left = nullptr;
+        for (const BeamEdge &beamEdge : beamEdges) {
+            bool wasInside = inside(winding);
+            winding += edges[beamEdge.edge].winding;
+            bool isInside = inside(winding);
+
+            if (!wasInside && isInside) {
+                left = &beamEdge;
+            } else if (wasInside && !isInside) {
+                // skip empty spans between coincident edges
+                if (left->xTop != beamEdge.xTop || left->xBottom != beamEdge.xBottom) {
+                    spans.push_back({left->edge, beamEdge.edge, y});
+                }
+            }
+        }
+
+        // keep the spans that go on, emit the ones that end here
+        for (Span &span : spans) {
+            for (Span &openSpan : openSpans) {
+                if (openSpan.left == span.left && openSpan.right == span.right) {
+                    span.yTop = openSpan.yTop;
+                    openSpan.left = openSpan.right; // matched
+                    break;
+                }
+            }
+        }
+        for (const Span &openSpan : openSpans) {
+            if (openSpan.left != openSpan.right) {
+                emitTrapezoid(mesh, color, openSpan, y);
+            }
+        }
+        openSpans.swap(spans);
+
+        y = yBottom;
+        while (nextScanline < scanlines.size() && scanlines[nextScanline] <= y) {
+            ++nextScanline;
+        }
+    }
+
+    for (const Span &openSpan : openSpans) {
+        emitTrapezoid(mesh, color, openSpan, y);
+    }
+
+    edges.clear();
+    scanlines.clear();
+    pointVertices.clear();
+}
+
+void FillTessellator::emitTrapezoid(Mesh &mesh, const Color &color, const Span &span, float yBottom) {
+    Edge &left = edges[span.left];
+    Edge &right = edges[span.right];
+
+    // the vertices of the previous batches can't be shared past this point.
+    mesh.beginVertices(4);
+
+    uint16_t topLeft = vertex(mesh, color, left, span.yTop);
+    uint16_t topRight = vertex(mesh, color, right, span.yTop);
+    uint16_t bottomRight = vertex(mesh, color, right, yBottom);
+    uint16_t bottomLeft = vertex(mesh, color, left, yBottom);
+
+    // spans starting or ending on a single point are triangles
+    if (topLeft != topRight) {
+        mesh.indices.push_back(topLeft);
+        mesh.indices.push_back(topRight);
+        mesh.indices.push_back(bottomRight);
+    }
+    if (bottomLeft != bottomRight) {
+        mesh.indices.push_back(topLeft);
+        mesh.indices.push_back(bottomRight);
+        mesh.indices.push_back(bottomLeft);
+    }
+}
+
+uint16_t FillTessellator::vertex(Mesh &mesh, const Color &color, Edge &edge, float y) {
+    uint32_t *vertex;
+    if (y <= edge.y0) {
+        vertex = &pointVertices[edge.topPoint];
+    } else if (y >= edge.y1) {
+        vertex = &pointVertices[edge.bottomPoint];
+    } else {
+        // the vertex of the edge at the previous scanline is of no use here.
+        if (edge.vertexY != y) {
+            edge.vertexY = y;
+            edge.vertex = UINT32_MAX;
+        }
+        vertex = &edge.vertex;
+    }
+
+    uint32_t batchOffset = mesh.batches.back().vertexOffset;
+    if (*vertex == UINT32_MAX || *vertex < batchOffset) {
+        *vertex = static_cast<uint32_t>(mesh.vertices.size());
+        mesh.vertices.push_back({{edge.xAt(y), y, 0.0f}, color});
+    }
+    return static_cast<uint16_t>(*vertex - batchOffset);
+}
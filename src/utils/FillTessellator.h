@@ -0,0 +1,79 @@
+#ifndef FILL_TESSELLATOR_H
+#define FILL_TESSELLATOR_H
+
+#include <cstdint>
+#include <vector>
+
+#include "VectorGraphic.h"
+
+// Scanline tessellator for Path2D::fill(). All the contours of a path are
+// swept together from top to bottom, the edges crossing each scanbeam are
+// sorted and the fill rule is applied to their winding numbers. The inside
+// spans become trapezoids, so overlapping subpaths, holes and self
+// intersections come out as a single set of non-overlapping triangles.
+class FillTessellator
+{
+public:
+    // adds a contour, implicitly closed.
+    void addContour(const std::vector<ContourPoint> &points);
+
+    // appends the triangles covering the contours added so far, according to
+    // 'fillRule', and forgets the contours.
+    void tessellate(Mesh &mesh, const Color &color, FillRule fillRule);
+
+    // tessellator of the calling thread, its buffers only grow.
+    static inline FillTessellator &current() {
+        static thread_local FillTessellator tessellator;
+        return tessellator;
+    }
+
+private:
+    // contour edge, stored top to bottom (y0 < y1).
+    struct Edge {
+        float x0, y0, x1, y1;
+        float dxdy;
+        int32_t winding; // +1 if the contour goes down along it, -1 if it goes up.
+
+        // contour points at its ends, see pointVertices.
+        uint32_t topPoint, bottomPoint;
+
+        // last vertex added somewhere along the edge. The trapezoids above and
+        // below it share it.
+        float vertexY;
+        uint32_t vertex;
+
+        inline float xAt(float y) const {
+            if (y <= y0) return x0;
+            if (y >= y1) return x1;
+            return x0 + (y - y0) * dxdy;
+        }
+    };
+
+    // edge crossing the current scanbeam.
+    struct BeamEdge {
+        uint32_t edge;
+        float xTop, xBottom;
+    };
+
+    // inside part of the scanbeam, between two edges. It is kept open while
+    // the following scanbeams have the same span, then emitted as a trapezoid.
+    struct Span {
+        uint32_t left, right;
+        float yTop;
+    };
+
+    void emitTrapezoid(Mesh &mesh, const Color &color, const Span &span, float yBottom);
+    uint16_t vertex(Mesh &mesh, const Color &color, Edge &edge, float y);
+
+    std::vector<Edge> edges;
+    std::vector<float> scanlines;
+    std::vector<uint32_t> activeEdges;
+    std::vector<BeamEdge> beamEdges;
+    std::vector<Span> openSpans;
+    std::vector<Span> spans;
+
+    // mesh vertex of every contour point, once a trapezoid has used it.
+    std::vector<uint32_t> pointVertices;
+};
+
+#endif // FILL_TESSELLATOR_H
@@ -5,6 +5,7 @@
 void IndexBuffer::renderUI() {
 
     if(ImGui::TreeNode("Index Buffer Object")) {
+        shadowCopiesInspected = true;
         if (ImGui::BeginTable(name.c_str(), 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
         {
             for (size_t i = 0; i < indices.size(); i++)
@@ -2,6 +2,7 @@
 #define INDEX_BUFFER_H
 
 #include <cstdint>
+#include <utility>
 #include <vector>
 
 #include <glad/glad.h>
@@ -18,9 +19,12 @@ struct IndexBuffer : public AbstractGPUObject
     };
 
     GLuint handle = 0;
+    size_t indexCount = 0;
+    Hint hint;
 
+    // CPU copy of the uploaded indices, kept for the inspectors while
+    // keepShadowCopies is set. Empty otherwise.
     std::vector<uint16_t> indices;
-    Hint hint;
 
     inline IndexBuffer(const std::string &name) : AbstractGPUObject(name)
     {
@@ -43,20 +47,57 @@ struct IndexBuffer : public AbstractGPUObject
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
 
+    // Uploads the 'count' indices at 'data', which may be released or
+    // unmapped right after.
+    inline void upload(const uint16_t *data, size_t count, Hint hint)
+    {
+        store(data, count, hint);
+        if (keepShadowCopies && isRegistered()) {
+            this->indices.assign(data, data + count);
+        } else {
+            std::vector<uint16_t>().swap(this->indices);
+        }
+    }
+
     inline void upload(const std::vector<uint16_t> &indices, Hint hint)
     {
-        this->indices = indices;
-        this->hint = hint;
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, handle);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * indices.size(), indices.data(), hint);
+        upload(indices.data(), indices.size(), hint);
+    }
+
+    // Takes 'indices' over, as the shadow copy when one is kept.
+    inline void upload(std::vector<uint16_t> &&indices, Hint hint)
+    {
+        store(indices.data(), indices.size(), hint);
+        if (keepShadowCopies && isRegistered()) {
+            this->indices = std::move(indices);
+        } else {
+            std::vector<uint16_t>().swap(this->indices);
+            std::vector<uint16_t>().swap(indices);
+        }
     }
 
     inline virtual size_t getMemoryUsage() const override {
-        return sizeof(uint16_t) * indices.size();
+        return sizeof(uint16_t) * indexCount;
+    }
+
+    inline virtual size_t getShadowMemoryUsage() const override {
+        return sizeof(uint16_t) * indices.capacity();
+    }
+
+    inline virtual void releaseShadowCopy() override {
+        std::vector<uint16_t>().swap(indices);
     }
 
     virtual void renderUI() override;
 
+private:
+    inline void store(const uint16_t *data, size_t count, Hint hint)
+    {
+        this->indexCount = count;
+        this->hint = hint;
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, handle);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * count, data, hint);
+    }
 };
 
 #endif // INDEX_BUFFER_H
@@ -0,0 +1,122 @@
+#include "LODMeshCache.h"
+
+#include <glm/glm.hpp>
+
+#include "ParallelTessellator.h"
+#include "TessellationCache.h"
+
+void LODMeshCache::clear() {
+    entries.clear();
+    mesh.clear();
+}
+
+void LODMeshCache::add(const BoundingBox &bounds, Tessellate tessellate, uint64_t key) {
+    entries.push_back({bounds, std::move(tessellate), key});
+}
+
+void LODMeshCache::add(Tessellate tessellate) {
+    Entry entry;
+    entry.tessellate = std::move(tessellate);
+
+    Mesh &bucketMesh = entry.meshes[0];
+    entry.tessellate(bucketMesh, tesselationFactor(0));
+    for (const ColorVertex &vertex : bucketMesh.vertices) {
+        entry.bounds.add(glm::vec2(vertex.position));
+    }
+
+    entries.push_back(std::move(entry));
+}
+
+void LODMeshCache::invalidate() {
+    for (Entry &entry : entries) {
+        entry.meshes.clear();
+        entry.bucket = MIN_BUCKET - 1;
+    }
+}
+
+float LODMeshCache::tesselationFactor(int32_t bucket) const {
+    // Path2D's tolerance is a squared distance: halving the distance
+    // tolerance for twice as many pixels per unit quadruples the factor.
+    float pixelsPerUnit = glm::exp2(static_cast<float>(bucket));
+    return baseTesselationFactor * pixelsPerUnit * pixelsPerUnit;
+}
+
+int32_t LODMeshCache::bucketFor(const BoundingBox &bounds, const glm::mat4 &mvp, glm::vec2 viewportSize) const {
+    if (bounds.empty()) {
+        return 0;
+    }
+
+    const glm::vec2 corners[4] = {
+        bounds.min,
+        glm::vec2(bounds.max.x, bounds.min.y),
+        bounds.max,
+        glm::vec2(bounds.min.x, bounds.max.y),
+    };
+
+    BoundingBox screenBounds;
+    for (const glm::vec2 &corner : corners) {
+        glm::vec4 clip = mvp * glm::vec4(corner, 0.0f, 1.0f);
+        if (clip.w <= glm::epsilon<float>()) {
+            // crosses the camera plane, assume the worst.
+            return MAX_BUCKET;
+        }
+        glm::vec2 ndc = glm::vec2(clip) / clip.w;
+        screenBounds.add((ndc * 0.5f + 0.5f) * viewportSize);
+    }
+
+    float unitSize = glm::length(bounds.max - bounds.min);
+    float pixelSize = glm::length(screenBounds.max - screenBounds.min);
+    if (unitSize <= glm::epsilon<float>() || pixelSize <= glm::epsilon<float>()) {
+        return MIN_BUCKET;
+    }
+
+    int32_t bucket = static_cast<int32_t>(glm::round(glm::log2(pixelSize / unitSize)));
+    return glm::clamp(bucket, MIN_BUCKET, MAX_BUCKET);
+}
+
+bool LODMeshCache::update(const glm::mat4 &mvp, glm::vec2 viewportSize) {
+    bool changed = false;
+
+    pendingMeshes.clear();
+    for (Entry &entry : entries) {
+        int32_t bucket = bucketFor(entry.bounds, mvp, viewportSize);
+        if (bucket == entry.bucket) {
+            continue;
+        }
+
+        entry.bucket = bucket;
+        changed = true;
+
+        auto it = entry.meshes.find(bucket);
+        if (it == entry.meshes.end()) {
+            pendingMeshes.push_back({&entry, &entry.meshes[bucket]});
+        }
+    }
+
+    // every entry has its own mesh, only the map insertions above had to be
+    // done on this thread. The disk cache is read and written from the
+    // workers too, so its I/O overlaps the tessellation of the other shapes.
+    ParallelTessellator::shared().parallelFor(pendingMeshes.size(), [this](size_t i) {
+        const PendingMesh &pending = pendingMeshes[i];
+        float factor = tesselationFactor(pending.entry->bucket);
+        bool cached = tessellationCache && pending.entry->key != 0;
+        if (cached && tessellationCache->load(pending.entry->key, factor, *pending.mesh)) {
+            return;
+        }
+        pending.entry->tessellate(*pending.mesh, factor);
+        if (cached) {
+            tessellationCache->store(pending.entry->key, factor, *pending.mesh);
+        }
+    });
+
+    if (!changed) {
+        return false;
+    }
+
+    mesh.clear();
+    for (const Entry &entry : entries) {
+        mesh.append(entry.meshes.at(entry.bucket));
+    }
+
+    return true;
+}
@@ -0,0 +1,86 @@
+#ifndef LOD_MESH_CACHE_H
+#define LOD_MESH_CACHE_H
+
+#include <functional>
+#include <map>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+
+#include "VectorGraphic.h"
+
+class TessellationCache;
+
+// Keeps every shape tessellated for how large it currently appears on screen.
+//
+// Each shape's bounds are projected with the MVP to estimate how many pixels
+// one unit covers. That scale is rounded to a power of two (the LOD bucket)
+// and the shape is tessellated with baseTesselationFactor scaled to match, so
+// the flattening error stays about the same in pixels whatever the zoom level.
+// Meshes are kept per bucket, so only shapes that cross a bucket boundary get
+// tessellated, and zooming back to a previous level costs nothing.
+class LODMeshCache
+{
+public:
+    using Tessellate = std::function<void(Mesh &mesh, float tesselationFactor)>;
+
+    static constexpr int32_t MIN_BUCKET = -8;
+    static constexpr int32_t MAX_BUCKET = 8;
+
+    // Tesselation factor used when one unit covers one pixel.
+    float baseTesselationFactor = 100.0f;
+
+    // Optional. The meshes of the shapes added with a key are loaded from it
+    // before tessellating them, and stored to it after.
+    TessellationCache *tessellationCache = nullptr;
+
+    void clear();
+
+    // Adds a shape. Without bounds, the shape is tessellated once at bucket 0
+    // and the bounds are taken from the resulting vertices. 'key' identifies
+    // the shape in tessellationCache (e.g. Path2D::contentHash()), 0 keeps it
+    // out of it.
+    void add(const BoundingBox &bounds, Tessellate tessellate, uint64_t key = 0);
+    void add(Tessellate tessellate);
+
+    // Picks the bucket of every shape for 'mvp' and rebuilds the combined mesh
+    // if any of them changed. The shapes missing a mesh for their new bucket
+    // are tessellated in parallel (see ParallelTessellator::shared()), so the
+    // tessellate functions must not share state. Returns true when getMesh()
+    // changed.
+    bool update(const glm::mat4 &mvp, glm::vec2 viewportSize);
+
+    // Drops all the cached meshes, e.g. after baseTesselationFactor changed.
+    void invalidate();
+
+    inline const Mesh &getMesh() const {
+        return mesh;
+    }
+
+    float tesselationFactor(int32_t bucket) const;
+
+private:
+
+    struct Entry {
+        BoundingBox bounds;
+        Tessellate tessellate;
+        uint64_t key = 0;
+        int32_t bucket = MIN_BUCKET - 1; // none yet
+        std::map<int32_t, Mesh> meshes;
+    };
+
+    // an entry missing the mesh of its bucket.
+    struct PendingMesh {
+        Entry *entry;
+        Mesh *mesh;
+    };
+
+    int32_t bucketFor(const BoundingBox &bounds, const glm::mat4 &mvp, glm::vec2 viewportSize) const;
+
+    std::vector<Entry> entries;
+    std::vector<PendingMesh> pendingMeshes;
+    Mesh mesh;
+};
+
+#endif // LOD_MESH_CACHE_H
@@ -0,0 +1,132 @@
+#include "MappedFile.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#define MAPPED_FILE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string &filePath) {
+    close();
+
+#ifdef MAPPED_FILE_MMAP
+    int fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat fileStat;
+    bool mapped = fstat(fd, &fileStat) == 0 && S_ISREG(fileStat.st_mode) && fileStat.st_size > 0 &&
+        map(fd, static_cast<size_t>(fileStat.st_size));
+
+    if (mapped) {
+        ::close(fd);
+        return true;
+    }
+
+    FILE *file = fdopen(fd, "rb");
+    if (!file) {
+        ::close(fd);
+        return false;
+    }
+#else
+    FILE *file = fopen(filePath.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+#endif
+
+    bool result = read(file);
+    fclose(file);
+    return result;
+}
+
+void MappedFile::close() {
+#ifdef MAPPED_FILE_MMAP
+    if (m_mappingSize) {
+        munmap(m_data, m_mappingSize);
+        m_mappingSize = 0;
+    }
+#endif
+    m_buffer.clear();
+    m_buffer.shrink_to_fit();
+    m_data = nullptr;
+    m_size = 0;
+}
+
+bool MappedFile::map(int fd, size_t size) {
+#ifdef MAPPED_FILE_MMAP
+    // The '\0' goes right after the file content. Past the end of the file
+    // the last page is zero filled, but if the file ends on a page boundary
+    // the '\0' needs a page of its own: an anonymous one is reserved first and
+    // the file is mapped over the front of it.
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t mappingSize = (size + 1 + pageSize - 1) / pageSize * pageSize;
+
+    void *reserved = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (reserved == MAP_FAILED) {
+        return false;
+    }
+
+    void *mapping = mmap(reserved, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        munmap(reserved, mappingSize);
+        return false;
+    }
+
+    // parsers read front to back
+    madvise(mapping, size, MADV_SEQUENTIAL);
+
+    m_data = static_cast<char *>(mapping);
+    m_data[size] = '\0';
+    m_size = size;
+    m_mappingSize = mappingSize;
+    return true;
+#else
+    (void)fd;
+    (void)size;
+    return false;
+#endif
+}
+
+bool MappedFile::read(FILE *file) {
+    // read straight into the final buffer when the size is known, otherwise
+    // (pipes, character devices) grow it until the end of the stream.
+    size_t capacity = 64 * 1024;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long fileSize = ftell(file);
+        if (fileSize >= 0) {
+            capacity = static_cast<size_t>(fileSize) + 1;
+        }
+        if (fseek(file, 0, SEEK_SET) != 0) {
+            return false;
+        }
+    }
+
+    size_t size = 0;
+    m_buffer.resize(capacity);
+    for (;;) {
+        size += fread(m_buffer.data() + size, 1, m_buffer.size() - size, file);
+        if (size < m_buffer.size()) {
+            break;
+        }
+        m_buffer.resize(m_buffer.size() * 2);
+    }
+
+    if (ferror(file)) {
+        close();
+        return false;
+    }
+
+    m_buffer.resize(size + 1);
+    m_buffer[size] = '\0';
+    m_data = m_buffer.data();
+    m_size = size;
+    return true;
+}
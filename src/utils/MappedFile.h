@@ -0,0 +1,51 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Writable, null terminated view of a file, meant for parsers working in place
+// like rapidxml. Regular files are mapped copy-on-write (MAP_PRIVATE), so the
+// pages the parser doesn't write to stay shared with the page cache and
+// nothing is ever written back to the file. Everything else (pipes, empty
+// files, platforms without mmap) is read once into a single heap buffer.
+// The content is released by close() or the destructor.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const std::string &filePath);
+    void close();
+
+    // 'size()' bytes followed by a '\0'. Null until open() succeeded.
+    inline char *data() const {
+        return m_data;
+    }
+
+    inline size_t size() const {
+        return m_size;
+    }
+
+    inline bool isMapped() const {
+        return m_mappingSize != 0;
+    }
+
+private:
+    bool map(int fd, size_t size);
+    bool read(FILE *file);
+
+    char *m_data = nullptr;
+    size_t m_size = 0;
+
+    size_t m_mappingSize = 0; // whole mapping, including the page(s) holding the '\0'
+    std::vector<char> m_buffer; // fallback
+};
+
+#endif // MAPPED_FILE_H
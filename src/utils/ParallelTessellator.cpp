@@ -0,0 +1,115 @@
+#include "ParallelTessellator.h"
+
+#include <algorithm>
+
+// shapes are handed out in chunks: enough per thread to even out the load
+// when their costs differ, few enough to keep the intermediate meshes large.
+static constexpr size_t CHUNKS_PER_THREAD = 8;
+
+ParallelTessellator::ParallelTessellator(uint32_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+    // no threads in the browser without SharedArrayBuffer, everything runs on the calling thread
+    threadCount = 1;
+#endif
+    workers.reserve(threadCount - 1);
+    for (uint32_t i = 1; i < threadCount; ++i) {
+        workers.emplace_back(&ParallelTessellator::workerLoop, this);
+    }
+}
+
+ParallelTessellator::~ParallelTessellator() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+ParallelTessellator &ParallelTessellator::shared() {
+    static ParallelTessellator tessellator;
+    return tessellator;
+}
+
+void ParallelTessellator::parallelFor(size_t count, const std::function<void(size_t index)> &job) {
+    if (workers.empty() || count <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            job(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->job = &job;
+        jobCount = count;
+        nextJob.store(0, std::memory_order_relaxed);
+        busyWorkers = static_cast<uint32_t>(workers.size());
+        ++generation;
+    }
+    wakeUp.notify_all();
+
+    runJobs();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return busyWorkers == 0; });
+    this->job = nullptr;
+}
+
+void ParallelTessellator::tessellate(Mesh &mesh, size_t count, const Draw &draw) {
+    size_t chunkCount = std::min(count, static_cast<size_t>(threadCount()) * CHUNKS_PER_THREAD);
+    if (chunkCount <= 1 || workers.empty()) {
+        for (size_t i = 0; i < count; ++i) {
+            draw(mesh, i);
+        }
+        return;
+    }
+
+    if (chunkMeshes.size() < chunkCount) {
+        chunkMeshes.resize(chunkCount);
+    }
+
+    parallelFor(chunkCount, [&](size_t chunk) {
+        Mesh &chunkMesh = chunkMeshes[chunk];
+        chunkMesh.clear();
+        size_t end = (chunk + 1) * count / chunkCount;
+        for (size_t i = chunk * count / chunkCount; i < end; ++i) {
+            draw(chunkMesh, i);
+        }
+    });
+
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        mesh.append(chunkMeshes[chunk]);
+    }
+}
+
+void ParallelTessellator::workerLoop() {
+    uint64_t lastGeneration = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wakeUp.wait(lock, [&] { return stopping || generation != lastGeneration; });
+        if (stopping) {
+            return;
+        }
+        lastGeneration = generation;
+
+        lock.unlock();
+        runJobs();
+        lock.lock();
+
+        if (--busyWorkers == 0) {
+            done.notify_one();
+        }
+    }
+}
+
+void ParallelTessellator::runJobs() {
+    for (size_t i = nextJob.fetch_add(1, std::memory_order_relaxed); i < jobCount; i = nextJob.fetch_add(1, std::memory_order_relaxed)) {
+        (*job)(i);
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef PARALLEL_TESSELLATOR_H
+#define PARALLEL_TESSELLATOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "VectorGraphic.h"
+
+// Pool of worker threads tessellating independent shapes, e.g. the paths of
+// an SVG document. Path2D keeps its scratch buffers per thread (see
+// FillTessellator::current() and CurveBatch::current()), so any number of
+// paths can be tessellated at once as long as each one is only used by one
+// job.
+class ParallelTessellator
+{
+public:
+    using Draw = std::function<void(Mesh &mesh, size_t index)>;
+
+    // 'threadCount' includes the calling thread, 0 picks one per core.
+    explicit ParallelTessellator(uint32_t threadCount = 0);
+    ~ParallelTessellator();
+
+    ParallelTessellator(const ParallelTessellator &) = delete;
+    ParallelTessellator &operator=(const ParallelTessellator &) = delete;
+
+    inline uint32_t threadCount() const {
+        return static_cast<uint32_t>(workers.size()) + 1;
+    }
+
+    // Calls job(i) for every i in [0, count) and returns once they are all
+    // done. The calling thread runs jobs too. Jobs can't call parallelFor().
+    void parallelFor(size_t count, const std::function<void(size_t index)> &job);
+
+    // Calls draw(mesh, i) for every i in [0, count) and appends the meshes to
+    // 'mesh' in index order, so painter's order is the same as drawing them
+    // one after the other. Consecutive shapes are drawn into the same
+    // intermediate mesh, whose buffers are kept for the next call.
+    void tessellate(Mesh &mesh, size_t count, const Draw &draw);
+
+    // pool shared by the viewer.
+    static ParallelTessellator &shared();
+
+private:
+    void workerLoop();
+    void runJobs();
+
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::condition_variable done;
+    uint64_t generation = 0; // incremented for every parallelFor()
+    uint32_t busyWorkers = 0;
+    bool stopping = false;
+
+    const std::function<void(size_t index)> *job = nullptr;
+    size_t jobCount = 0;
+    std::atomic<size_t> nextJob{0};
+
+    std::vector<Mesh> chunkMeshes;
+};
+
+#endif // PARALLEL_TESSELLATOR_H
@@ -0,0 +1,85 @@
+#ifndef PERFECT_HASH_H
+#define PERFECT_HASH_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Maps a fixed set of names to their index with one hash and one string
+// compare. The hash seed is searched at compile time so that every name gets
+// a slot of its own, e.g.
+//
+//   static constexpr PerfectHash<3, 8> primaries({"red", "green", "blue"});
+//   primaries.find("green") == 1
+//   primaries.find("pink") == primaries.notFound
+//
+// A larger TableSize makes the seed search shorter.
+template <size_t Count, size_t TableSize>
+class PerfectHash
+{
+    static_assert((TableSize & (TableSize - 1)) == 0, "TableSize must be a power of two");
+    static_assert(Count < TableSize && TableSize < 0xFFFF, "TableSize must be larger than Count");
+
+public:
+    static constexpr size_t notFound = Count;
+
+    constexpr PerfectHash(const std::string_view (&names)[Count]) {
+        for (size_t i = 0; i < Count; ++i) {
+            this->names[i] = names[i];
+        }
+        for (uint32_t candidate = 1; candidate < MAX_SEED; ++candidate) {
+            if (tryFill(candidate)) {
+                seed = candidate;
+                return;
+            }
+        }
+        // no seed found: fails the constant evaluation, increase TableSize.
+        throw "PerfectHash: no collision free seed, increase TableSize";
+    }
+
+    constexpr size_t find(std::string_view name) const {
+        uint16_t index = slots[slot(seed, name)];
+        return index != EMPTY && names[index] == name ? index : notFound;
+    }
+
+    constexpr std::string_view name(size_t index) const {
+        return names[index];
+    }
+
+private:
+    static constexpr uint16_t EMPTY = 0xFFFF;
+    static constexpr uint32_t MAX_SEED = 1u << 16;
+
+    // FNV-1a and the murmur3 finalizer, so the low bits depend on every character.
+    static constexpr size_t slot(uint32_t seed, std::string_view name) {
+        uint32_t hash = 2166136261u ^ seed;
+        for (size_t i = 0; i < name.size(); ++i) {
+            hash = (hash ^ static_cast<uint8_t>(name[i])) * 16777619u;
+        }
+        hash ^= hash >> 16;
+        hash *= 0x85EBCA6Bu;
+        hash ^= hash >> 13;
+        return hash & (TableSize - 1);
+    }
+
+    constexpr bool tryFill(uint32_t candidate) {
+        for (size_t i = 0; i < TableSize; ++i) {
+            slots[i] = EMPTY;
+        }
+        for (size_t i = 0; i < Count; ++i) {
+            uint16_t &entry = slots[slot(candidate, names[i])];
+            if (entry != EMPTY) {
+                return false;
+            }
+            entry = static_cast<uint16_t>(i);
+        }
+        return true;
+    }
+
+    std::array<std::string_view, Count> names = {};
+    std::array<uint16_t, TableSize> slots = {};
+    uint32_t seed = 0;
+};
+
+#endif // PERFECT_HASH_H
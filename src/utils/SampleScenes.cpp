@@ -0,0 +1,195 @@
+#include "SampleScenes.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include "BinaryScene.h"
+#include "ParallelTessellator.h"
+#include "TessellationCache.h"
+
+void roundedRect(Path2D &ctx, Mesh &mesh, float x, float y, float width, float height, float radius) {
+  ctx.beginPath();
+  ctx.moveTo(x, y + radius);
+  ctx.lineTo(x, y + height - radius);
+  ctx.arcTo(x, y + height, x + radius, y + height, radius);
+  ctx.lineTo(x + width - radius, y + height);
+  ctx.arcTo(x + width, y + height, x + width, y + height-radius, radius);
+  ctx.lineTo(x + width, y + radius);
+  ctx.arcTo(x + width, y, x + width - radius, y, radius);
+  ctx.lineTo(x + radius, y);
+  ctx.arcTo(x, y, x, y + radius, radius);
+  ctx.fillStyle = Transparent;
+  ctx.stroke(mesh);
+}
+
+void drawHeart(Mesh &mesh, float tesselationFactor) {
+    Path2D ctx(tesselationFactor);
+    ctx.beginPath();
+    ctx.moveTo(75, 40);
+    ctx.bezierCurveTo(75, 37, 70, 25, 50, 25);
+    ctx.bezierCurveTo(20, 25, 20, 62.5, 20, 62.5);
+    ctx.bezierCurveTo(20, 80, 40, 102, 75, 120);
+    ctx.bezierCurveTo(110, 102, 130, 80, 130, 62.5);
+    ctx.bezierCurveTo(130, 62.5, 130, 25, 100, 25);
+    ctx.bezierCurveTo(85, 25, 75, 37, 75, 40);
+    ctx.fillStyle = Crimson;
+    ctx.fill(mesh);
+}
+
+void drawSmiley(Mesh &mesh, float tesselationFactor) {
+    const float pi = glm::pi<float>();
+
+    Path2D ctx(tesselationFactor);
+    ctx.beginPath();
+    ctx.arc(75, 75, 50, 0, pi * 2.0f, true); // Outer circle
+    ctx.moveTo(110, 75);
+    ctx.arc(75, 75, 35, 0, pi, false); // Mouth (clockwise)
+    ctx.moveTo(65, 65);
+    ctx.arc(60.0f, 65.0f, 5.0f, 0.0f, pi * 2.0f, true); // Left eye
+    ctx.moveTo(95.0f, 65.0f);
+    ctx.arc(90.0f, 65.0f, 5.0f, 0.0f, pi * 2.0f, true); // Right eye
+    ctx.fillStyle = Transparent;
+    ctx.strokeStyle = DarkMagenta;
+    ctx.stroke(mesh);
+}
+
+void drawPacmanGame(Mesh &mesh, float tesselationFactor) {
+    const float pi = glm::pi<float>();
+
+    Path2D ctx(tesselationFactor);
+
+    roundedRect(ctx, mesh, 12, 12, 150, 150, 15);
+    roundedRect(ctx, mesh, 19, 19, 150, 150, 9);
+    roundedRect(ctx, mesh, 53, 53, 49, 33, 10);
+    roundedRect(ctx, mesh, 53, 119, 49, 16, 6);
+    roundedRect(ctx, mesh, 135, 53, 49, 33, 10);
+    roundedRect(ctx, mesh, 135, 119, 25, 49, 10);
+
+    ctx.fillStyle = Yellow;
+    ctx.beginPath();
+    ctx.arc(37, 37, 13, pi / 7.0f, -pi / 7.0f, false);
+    ctx.lineTo(31, 37);
+    ctx.fill(mesh);
+
+    for (int i = 0; i < 8; i++) {
+        ctx.fillStyle = Gold;
+        ctx.fillRect(mesh, 51 + i * 16, 35, 4, 4);
+    }
+
+    for (int i = 0; i < 6; i++) {
+        ctx.fillStyle = Gold;
+        ctx.fillRect(mesh, 115, 51 + i * 16, 4, 4);
+    }
+
+    for (int i = 0; i < 8; i++) {
+        ctx.fillStyle = Gold;
+        ctx.fillRect(mesh, 51 + i * 16, 99, 4, 4);
+    }
+
+    ctx.fillStyle = FireBrick;
+    ctx.beginPath();
+    ctx.moveTo(83, 116);
+    ctx.lineTo(83, 102);
+    ctx.bezierCurveTo(83, 94, 89, 88, 97, 88);
+    ctx.bezierCurveTo(105, 88, 111, 94, 111, 102);
+    ctx.lineTo(111, 116);
+    ctx.lineTo(106.333, 111.333);
+    ctx.lineTo(101.666, 116);
+    ctx.lineTo(97, 111.333);
+    ctx.lineTo(92.333, 116);
+    ctx.lineTo(87.666, 111.333);
+    ctx.lineTo(83, 116);
+    ctx.fill(mesh);
+
+    ctx.fillStyle = White;
+    ctx.beginPath();
+    ctx.moveTo(91, 96);
+    ctx.bezierCurveTo(88, 96, 87, 99, 87, 101);
+    ctx.bezierCurveTo(87, 103, 88, 106, 91, 106);
+    ctx.bezierCurveTo(94, 106, 95, 103, 95, 101);
+    ctx.bezierCurveTo(95, 99, 94, 96, 91, 96);
+    ctx.moveTo(103, 96);
+    ctx.bezierCurveTo(100, 96, 99, 99, 99, 101);
+    ctx.bezierCurveTo(99, 103, 100, 106, 103, 106);
+    ctx.bezierCurveTo(106, 106, 107, 103, 107, 101);
+    ctx.bezierCurveTo(107, 99, 106, 96, 103, 96);
+    ctx.fill(mesh);
+
+    ctx.fillStyle = Black;
+    ctx.beginPath();
+    ctx.arc(101, 102, 2, 0, pi * 2.0f, true);
+    ctx.fill(mesh);
+
+    ctx.beginPath();
+    ctx.arc(89, 102, 2, 0, pi * 2.0f, true);
+    ctx.fill(mesh);
+}
+
+void drawSVGFile(Mesh &mesh, const std::string &filePath, float tesselationFactor) {
+    std::vector<Path2D> paths = Path2D::fromSVGFile(filePath, Unit::px, 96, tesselationFactor);
+    drawSVGPaths(mesh, paths, tesselationFactor);
+}
+
+void streamSVGFile(Mesh &mesh, const std::string &filePath, float tesselationFactor) {
+    Path2D::streamSVGFile(filePath, Unit::px, 96, tesselationFactor, [&](Path2D &path) {
+        drawSVGPath(mesh, path, tesselationFactor);
+    });
+}
+
+void drawSVGPaths(Mesh &mesh, std::vector<Path2D> &paths, float tesselationFactor) {
+    for(size_t i = 0; i < paths.size(); ++i) {
+        drawSVGPath(mesh, paths[i], tesselationFactor);
+    }
+}
+
+void drawSVGPaths(Mesh &mesh, std::vector<Path2D> &paths, float tesselationFactor, ParallelTessellator &parallelTessellator) {
+    parallelTessellator.tessellate(mesh, paths.size(), [&](Mesh &chunkMesh, size_t i) {
+        drawSVGPath(chunkMesh, paths[i], tesselationFactor);
+    });
+}
+
+void drawSVGPaths(Mesh &mesh, std::vector<Path2D> &paths, float tesselationFactor, TessellationCache &tessellationCache) {
+    Mesh pathMesh;
+    for (Path2D &path : paths) {
+        uint64_t key = path.contentHash();
+        if (!tessellationCache.load(key, tesselationFactor, pathMesh)) {
+            drawSVGPath(pathMesh, path, tesselationFactor);
+            tessellationCache.store(key, tesselationFactor, pathMesh);
+        }
+        mesh.append(pathMesh);
+    }
+}
+
+void drawSVGPath(Mesh &mesh, Path2D &path, float tesselationFactor) {
+    path.setTesselationFactor(tesselationFactor);
+    if (path.strokeStyle != Transparent) {
+        path.stroke(mesh);
+    } else {
+        path.fill(mesh);
+    }
+}
+
+bool writeBinaryScene(const std::string &svgFilePath, const std::string &sceneFilePath, const std::vector<float> &lodTesselationFactors) {
+    std::vector<Path2D> paths = Path2D::fromSVGFile(svgFilePath, Unit::px, 96, 100.0f);
+    if (paths.empty()) {
+        return false;
+    }
+    return BinaryScene::write(sceneFilePath, paths, lodTesselationFactors, drawSVGPath);
+}
+
+void drawBinaryScene(Mesh &mesh, const BinaryScene &scene, float tesselationFactor) {
+    for (size_t i = 0; i < scene.pathCount(); ++i) {
+        drawBinaryScenePath(mesh, scene, i, tesselationFactor);
+    }
+}
+
+void drawBinaryScenePath(Mesh &mesh, const BinaryScene &scene, size_t index, float tesselationFactor) {
+    // the baked meshes are only the ones drawSVGPath() would make with the
+    // curve flattener they were baked with.
+    size_t lod = scene.findLod(tesselationFactor);
+    if (lod != BinaryScene::noLod && scene.pathCurveFlattener(index) == Path2D::defaultCurveFlattener &&
+        scene.appendPathMesh(mesh, lod, index)) {
+        return;
+    }
+    Path2D path = scene.path(index, tesselationFactor);
+    drawSVGPath(mesh, path, tesselationFactor);
+}
@@ -0,0 +1,48 @@
+#ifndef SAMPLE_SCENES_H
+#define SAMPLE_SCENES_H
+
+#include <string>
+#include <vector>
+
+#include "VectorGraphic.h"
+
+class BinaryScene;
+class ParallelTessellator;
+class TessellationCache;
+
+// The scenes shown by Sample02_VG_Trig. They only depend on Path2D so they can
+// also be tessellated headless by VectorGraphicViewerBench.
+
+void roundedRect(Path2D &ctx, Mesh &mesh, float x, float y, float width, float height, float radius);
+
+void drawHeart(Mesh &mesh, float tesselationFactor);
+void drawSmiley(Mesh &mesh, float tesselationFactor);
+void drawPacmanGame(Mesh &mesh, float tesselationFactor);
+void drawSVGFile(Mesh &mesh, const std::string &filePath, float tesselationFactor);
+
+// Same as drawSVGFile(), through Path2D::streamSVGFile(): every path is
+// tessellated as soon as it is read instead of loading the whole document.
+void streamSVGFile(Mesh &mesh, const std::string &filePath, float tesselationFactor);
+
+// Tessellates paths loaded earlier, e.g. by Path2D::fromSVGFile(), at a new
+// tesselation factor without reading or parsing the file again.
+void drawSVGPaths(Mesh &mesh, std::vector<Path2D> &paths, float tesselationFactor);
+// Same, with the paths spread over the threads of 'parallelTessellator'.
+void drawSVGPaths(Mesh &mesh, std::vector<Path2D> &paths, float tesselationFactor, ParallelTessellator &parallelTessellator);
+// Same, loading the meshes from 'tessellationCache' and storing the ones it misses.
+void drawSVGPaths(Mesh &mesh, std::vector<Path2D> &paths, float tesselationFactor, TessellationCache &tessellationCache);
+void drawSVGPath(Mesh &mesh, Path2D &path, float tesselationFactor);
+
+// Converts an SVG file to a BinaryScene, with its meshes baked for every
+// factor of 'lodTesselationFactors'. Returns false if the SVG file can't be
+// loaded or the scene can't be written.
+bool writeBinaryScene(const std::string &svgFilePath, const std::string &sceneFilePath, const std::vector<float> &lodTesselationFactors);
+
+// Draws an opened BinaryScene: appends its baked meshes if it has some for
+// 'tesselationFactor' and Path2D::defaultCurveFlattener, tessellates its paths
+// otherwise.
+void drawBinaryScene(Mesh &mesh, const BinaryScene &scene, float tesselationFactor);
+// Same, for one of its paths.
+void drawBinaryScenePath(Mesh &mesh, const BinaryScene &scene, size_t index, float tesselationFactor);
+
+#endif // SAMPLE_SCENES_H
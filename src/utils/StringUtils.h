@@ -1,8 +1,14 @@
 #ifndef STRING_UTIL_H
 #define STRING_UTIL_H
 
+#include <cmath>
+#include <cstdint>
 #include <string>
 
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+
 static const char* ws = " \t\n\r\f\v";
 
 // trim from end of string (right)
@@ -25,4 +31,114 @@ inline std::string& trim(std::string& s, const char* t = ws)
     return ltrim(rtrim(s, t), t);
 }
 
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// Parses a number of the SVG grammar, [+-]digits[.digits][(e|E)[+-]digits],
+// at 'cur' and moves 'cur' past it. "1.5.5" is two numbers and "5e" stops
+// before the 'e', like the SVG spec says. Unlike atof() and strtof() it
+// doesn't depend on the locale.
+inline bool parseNumber(const char *&cur, const char *end, float &value)
+{
+    const char *p = cur;
+    bool negative = false;
+    if (p < end && (*p == '+' || *p == '-')) {
+        negative = *p == '-';
+        ++p;
+    }
+
+    // the digits are accumulated on the way, most numbers in path data are
+    // short enough to be converted right away.
+    uint64_t mantissa = 0;
+    int digitCount = 0;
+    int fractionDigitCount = 0;
+
+    const char *integer = p;
+    for (; p < end && isDigit(*p); ++p) {
+        mantissa = mantissa * 10 + (*p - '0');
+        ++digitCount;
+    }
+    bool hasDigits = p > integer;
+    if (p < end && *p == '.') {
+        ++p;
+        const char *fraction = p;
+        for (; p < end && isDigit(*p); ++p) {
+            mantissa = mantissa * 10 + (*p - '0');
+            ++digitCount;
+        }
+        fractionDigitCount = static_cast<int>(p - fraction);
+        hasDigits |= p > fraction;
+    }
+    if (!hasDigits) {
+        return false;
+    }
+
+    bool hasExponent = false;
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char *exponent = p + 1;
+        if (exponent < end && (*exponent == '+' || *exponent == '-')) ++exponent;
+        if (exponent < end && isDigit(*exponent)) {
+            hasExponent = true;
+            p = exponent;
+            while (p < end && isDigit(*p)) ++p;
+        }
+    }
+
+    const char *begin = cur;
+    cur = p;
+
+    // Fast path: an integer that fits in a float mantissa divided by an exact
+    // power of ten is correctly rounded by the division alone.
+    static const float powersOf10[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+    if (!hasExponent && digitCount <= 7 && fractionDigitCount <= 10) {
+        float result = static_cast<float>(mantissa) / powersOf10[fractionDigitCount];
+        value = negative ? -result : result;
+        return true;
+    }
+
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    // from_chars() doesn't take a leading '+'
+    if (*begin == '+') ++begin;
+    return std::from_chars(begin, p, value).ec == std::errc();
+#else
+    if (*begin == '+' || *begin == '-') ++begin;
+
+    // up to 19 significant digits fit in the 64 bits, the rest only moves the exponent.
+    uint64_t digits = 0;
+    int significantDigitCount = 0;
+    int exponent = 0;
+    bool inFraction = false;
+    for (; begin < p && *begin != 'e' && *begin != 'E'; ++begin) {
+        if (*begin == '.') {
+            inFraction = true;
+        } else if (significantDigitCount < 19) {
+            digits = digits * 10 + (*begin - '0');
+            significantDigitCount += digits > 0;
+            exponent -= inFraction;
+        } else {
+            exponent += !inFraction;
+        }
+    }
+    if (begin < p) {
+        ++begin;
+        bool negativeExponent = *begin == '-';
+        if (*begin == '+' || *begin == '-') ++begin;
+        int explicitExponent = 0;
+        for (; begin < p && explicitExponent < 100000; ++begin) {
+            explicitExponent = explicitExponent * 10 + (*begin - '0');
+        }
+        exponent += negativeExponent ? -explicitExponent : explicitExponent;
+    }
+
+    double result = static_cast<double>(digits);
+    if (exponent != 0 && digits != 0) {
+        result *= std::pow(10.0, exponent);
+    }
+    value = static_cast<float>(negative ? -result : result);
+    return true;
+#endif
+}
+
 #endif // STRING_UTIL_H
\ No newline at end of file
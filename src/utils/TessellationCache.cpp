@@ -0,0 +1,224 @@
+#include "TessellationCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static constexpr uint32_t ENTRY_MAGIC = 0x43544756; // "VGTC"
+static constexpr const char *ENTRY_EXTENSION = ".mesh";
+static constexpr const char *TEMPORARY_EXTENSION = ".tmp";
+
+// temporary files older than this were left by a process that died writing them.
+static constexpr std::chrono::hours STALE_TEMPORARY_AGE(1);
+
+struct EntryHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t batchCount;
+    uint32_t padding;
+};
+
+// splitmix64 finalizer.
+static inline uint64_t mix(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+static uint64_t entryKey(uint64_t shapeKey, float tesselationFactor) {
+    uint32_t factorBits;
+    memcpy(&factorBits, &tesselationFactor, sizeof(factorBits));
+    return mix(shapeKey ^ mix((static_cast<uint64_t>(factorBits) << 32) | TessellationCache::TESSELLATOR_VERSION));
+}
+
+TessellationCache::TessellationCache(const std::string &directory, uint64_t maxSize)
+    : m_directory(directory)
+    , m_maxSize(maxSize)
+{
+    std::random_device random;
+    m_temporaryId = (static_cast<uint64_t>(random()) << 32) ^ random() ^
+        static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+
+    if (m_directory.empty()) {
+        return;
+    }
+
+    std::error_code error;
+    fs::create_directories(m_directory, error);
+    if (!fs::is_directory(m_directory, error)) {
+        m_directory.clear();
+        return;
+    }
+
+    uint64_t size = 0;
+    for (fs::directory_iterator it(m_directory, error), end; !error && it != end; it.increment(error)) {
+        std::error_code entryError;
+        uint64_t entrySize = it->file_size(entryError);
+        if (!entryError && it->path().extension() == ENTRY_EXTENSION) {
+            size += entrySize;
+        }
+    }
+    m_size = size;
+}
+
+std::string TessellationCache::entryPath(uint64_t shapeKey, float tesselationFactor) const {
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx", static_cast<unsigned long long>(entryKey(shapeKey, tesselationFactor)));
+    return m_directory + name + ENTRY_EXTENSION;
+}
+
+bool TessellationCache::load(uint64_t shapeKey, float tesselationFactor, Mesh &mesh) {
+    mesh.clear();
+    if (!enabled()) {
+        return false;
+    }
+
+    std::string path = entryPath(shapeKey, tesselationFactor);
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+
+    long fileSize = 0;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        fileSize = ftell(file);
+        fseek(file, 0, SEEK_SET);
+    }
+
+    // the counts are checked against the file size before anything is allocated.
+    EntryHeader header;
+    bool loaded = fread(&header, sizeof(header), 1, file) == 1 &&
+        header.magic == ENTRY_MAGIC &&
+        header.version == TESSELLATOR_VERSION &&
+        header.key == entryKey(shapeKey, tesselationFactor) &&
+        static_cast<uint64_t>(fileSize) == sizeof(header) +
+            static_cast<uint64_t>(header.vertexCount) * sizeof(ColorVertex) +
+            static_cast<uint64_t>(header.indexCount) * sizeof(uint16_t) +
+            static_cast<uint64_t>(header.batchCount) * sizeof(MeshBatch);
+
+    if (loaded) {
+        mesh.vertices.resize(header.vertexCount);
+        mesh.indices.resize(header.indexCount);
+        mesh.batches.resize(header.batchCount);
+        loaded = fread(mesh.vertices.data(), sizeof(ColorVertex), header.vertexCount, file) == header.vertexCount &&
+            fread(mesh.indices.data(), sizeof(uint16_t), header.indexCount, file) == header.indexCount &&
+            fread(mesh.batches.data(), sizeof(MeshBatch), header.batchCount, file) == header.batchCount &&
+            mesh.view().isValid();
+    }
+    fclose(file);
+
+    if (!loaded) {
+        mesh.clear();
+        return false;
+    }
+
+    // the modification time orders the entries for evict().
+    std::error_code error;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+    return true;
+}
+
+bool TessellationCache::store(uint64_t shapeKey, float tesselationFactor, const Mesh &mesh) {
+    if (!enabled()) {
+        return false;
+    }
+
+    std::string path = entryPath(shapeKey, tesselationFactor);
+    std::string temporaryPath = path + TEMPORARY_EXTENSION + std::to_string(m_temporaryId) + "-" + std::to_string(m_temporaryCount++);
+
+    FILE *file = fopen(temporaryPath.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    EntryHeader header = {};
+    header.magic = ENTRY_MAGIC;
+    header.version = TESSELLATOR_VERSION;
+    header.key = entryKey(shapeKey, tesselationFactor);
+    header.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+    header.indexCount = static_cast<uint32_t>(mesh.indices.size());
+    header.batchCount = static_cast<uint32_t>(mesh.batches.size());
+
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+        fwrite(mesh.vertices.data(), sizeof(ColorVertex), mesh.vertices.size(), file) == mesh.vertices.size() &&
+        fwrite(mesh.indices.data(), sizeof(uint16_t), mesh.indices.size(), file) == mesh.indices.size() &&
+        fwrite(mesh.batches.data(), sizeof(MeshBatch), mesh.batches.size(), file) == mesh.batches.size();
+    written = fclose(file) == 0 && written;
+
+    // replaces the entry in one step, even if another process is storing the same one.
+    std::error_code error;
+    if (written) {
+        fs::rename(temporaryPath, path, error);
+    }
+    if (!written || error) {
+        fs::remove(temporaryPath, error);
+        return false;
+    }
+
+    uint64_t entrySize = sizeof(header) + mesh.vertices.size() * sizeof(ColorVertex) +
+        mesh.indices.size() * sizeof(uint16_t) + mesh.batches.size() * sizeof(MeshBatch);
+    if (m_size.fetch_add(entrySize) + entrySize > m_maxSize) {
+        evict();
+    }
+    return true;
+}
+
+void TessellationCache::evict() {
+    std::lock_guard<std::mutex> lock(m_evictionMutex);
+
+    struct Entry {
+        fs::path path;
+        uint64_t size;
+        fs::file_time_type time;
+    };
+    std::vector<Entry> entries;
+    uint64_t size = 0;
+
+    fs::file_time_type now = fs::file_time_type::clock::now();
+    std::error_code error;
+    for (fs::directory_iterator it(m_directory, error), end; !error && it != end; it.increment(error)) {
+        std::error_code entryError;
+        const fs::path &path = it->path();
+        fs::file_time_type time = it->last_write_time(entryError);
+        if (entryError) {
+            continue;
+        }
+        if (path.extension() == ENTRY_EXTENSION) {
+            uint64_t entrySize = it->file_size(entryError);
+            if (!entryError) {
+                entries.push_back({path, entrySize, time});
+                size += entrySize;
+            }
+        } else if (path.filename().string().find(std::string(ENTRY_EXTENSION) + TEMPORARY_EXTENSION) != std::string::npos &&
+                   now - time > STALE_TEMPORARY_AGE) {
+            fs::remove(path, entryError);
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return a.time < b.time;
+    });
+
+    uint64_t targetSize = m_maxSize / 4 * 3;
+    for (const Entry &entry : entries) {
+        if (size <= targetSize) {
+            break;
+        }
+        std::error_code entryError;
+        fs::remove(entry.path, entryError);
+        if (!entryError) {
+            size -= entry.size;
+        }
+    }
+
+    m_size = size;
+}
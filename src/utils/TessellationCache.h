@@ -0,0 +1,66 @@
+#ifndef TESSELLATION_CACHE_H
+#define TESSELLATION_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "VectorGraphic.h"
+
+// Meshes tessellated by earlier runs, kept on disk so the next launch loads
+// them instead of tessellating the same shapes again.
+//
+// Entries are content addressed: the key of a shape (e.g.
+// Path2D::contentHash(), which covers its commands and style) is mixed with
+// the tesselation factor and TESSELLATOR_VERSION into the name of the entry,
+// so a different shape, factor or tessellator misses instead of returning a
+// stale mesh. Beyond 'maxSize', the least recently used entries are deleted.
+//
+// Entries are written to a temporary file then renamed, so viewers sharing
+// the directory only ever see complete entries. Thread safe.
+class TessellationCache
+{
+public:
+    // to bump whenever a change to Path2D changes the meshes it makes.
+    static constexpr uint32_t TESSELLATOR_VERSION = 1;
+    static constexpr uint64_t DEFAULT_MAX_SIZE = 64 * 1024 * 1024;
+
+    // Creates 'directory' if needed. An empty directory disables the cache.
+    explicit TessellationCache(const std::string &directory, uint64_t maxSize = DEFAULT_MAX_SIZE);
+
+    TessellationCache(const TessellationCache &) = delete;
+    TessellationCache &operator=(const TessellationCache &) = delete;
+
+    inline bool enabled() const {
+        return !m_directory.empty();
+    }
+
+    // Replaces 'mesh' with the one stored for 'shapeKey' at
+    // 'tesselationFactor'. Returns false, leaving 'mesh' empty, on a miss or
+    // if the entry is unreadable.
+    bool load(uint64_t shapeKey, float tesselationFactor, Mesh &mesh);
+
+    // Returns false if the entry couldn't be written, e.g. the disk is full.
+    bool store(uint64_t shapeKey, float tesselationFactor, const Mesh &mesh);
+
+private:
+    std::string entryPath(uint64_t shapeKey, float tesselationFactor) const;
+
+    // deletes the least recently used entries until the cache is back under
+    // 3/4 of maxSize, leaving room for a few more stores.
+    void evict();
+
+    std::string m_directory;
+    uint64_t m_maxSize;
+
+    // size of the entries, as far as this process knows. evict() counts them
+    // again, for the entries written and deleted by other processes.
+    std::atomic<uint64_t> m_size{0};
+    std::mutex m_evictionMutex;
+
+    uint64_t m_temporaryId; // distinguishes the temporary files of this process
+    std::atomic<uint64_t> m_temporaryCount{0};
+};
+
+#endif // TESSELLATION_CACHE_H
@@ -0,0 +1,103 @@
+#ifndef TESSELLATION_STATS_H
+#define TESSELLATION_STATS_H
+
+#include <chrono>
+#include <cstdint>
+
+// Per-phase timing of the Path2D pipeline. Only compiled in when
+// VECTOR_GRAPHIC_STATS is defined (see the VectorGraphicViewerBench target) so
+// the viewer itself doesn't pay for the clock reads.
+
+enum class TessellationPhase : uint8_t
+{
+    parse = 0, // XML and SVG path data parsing
+    flatten, // curves, arcs and lines turned into contour points
+    strokeExpansion, // contour points extruded into stroke outlines
+    triangulation, // fill tessellation
+    meshAppend, // copying the triangles into the Mesh
+    count,
+    none = count
+};
+
+inline const char *tessellationPhaseToString(TessellationPhase phase) {
+    switch (phase) {
+        case TessellationPhase::parse: return "parse";
+        case TessellationPhase::flatten: return "flatten";
+        case TessellationPhase::strokeExpansion: return "strokeExpansion";
+        case TessellationPhase::triangulation: return "triangulation";
+        case TessellationPhase::meshAppend: return "meshAppend";
+        default: return "?";
+    }
+}
+
+struct TessellationStats
+{
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t nanoseconds[static_cast<size_t>(TessellationPhase::count)] = {};
+    uint64_t contourPoints = 0; // flattened points handed to fill() and stroke()
+
+    inline void reset() {
+        *this = TessellationStats();
+    }
+
+    inline double milliseconds(TessellationPhase phase) const {
+        return nanoseconds[static_cast<size_t>(phase)] / 1000000.0;
+    }
+
+    // stats of the calling thread.
+    static inline TessellationStats &current() {
+        static thread_local TessellationStats stats;
+        return stats;
+    }
+};
+
+// Accumulates the time spent in its own scope into 'phase'. Nested scopes pause
+// the enclosing one, so every phase reports exclusive time (e.g. parsing an SVG
+// file doesn't also count the flattening it triggers).
+class TessellationPhaseScope
+{
+public:
+    inline TessellationPhaseScope(TessellationPhase phase) {
+        TessellationStats::Clock::time_point now = TessellationStats::Clock::now();
+        if (s_currentPhase != TessellationPhase::none) {
+            accumulate(s_currentPhase, now);
+        }
+        m_previousPhase = s_currentPhase;
+        s_currentPhase = phase;
+        s_phaseStart = now;
+    }
+
+    inline ~TessellationPhaseScope() {
+        TessellationStats::Clock::time_point now = TessellationStats::Clock::now();
+        accumulate(s_currentPhase, now);
+        s_currentPhase = m_previousPhase;
+        s_phaseStart = now;
+    }
+
+    TessellationPhaseScope(const TessellationPhaseScope &) = delete;
+    TessellationPhaseScope &operator=(const TessellationPhaseScope &) = delete;
+
+private:
+    static inline void accumulate(TessellationPhase phase, TessellationStats::Clock::time_point now) {
+        TessellationStats::current().nanoseconds[static_cast<size_t>(phase)] +=
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - s_phaseStart).count();
+    }
+
+    TessellationPhase m_previousPhase;
+
+    static inline thread_local TessellationPhase s_currentPhase = TessellationPhase::none;
+    static inline thread_local TessellationStats::Clock::time_point s_phaseStart;
+};
+
+#ifdef VECTOR_GRAPHIC_STATS
+#define VG_PROFILE_CONCAT_IMPL(a, b) a##b
+#define VG_PROFILE_CONCAT(a, b) VG_PROFILE_CONCAT_IMPL(a, b)
+#define VG_PROFILE_PHASE(PHASE) TessellationPhaseScope VG_PROFILE_CONCAT(_tessellationPhaseScope, __LINE__)(TessellationPhase::PHASE)
+#define VG_PROFILE_COUNT(COUNTER, VALUE) (TessellationStats::current().COUNTER += (VALUE))
+#else
+#define VG_PROFILE_PHASE(PHASE) do {} while((void)0, 0)
+#define VG_PROFILE_COUNT(COUNTER, VALUE) do {} while((void)0, 0)
+#endif
+
+#endif // TESSELLATION_STATS_H
@@ -0,0 +1,118 @@
+#ifndef TRANSFORM_2D_H
+#define TRANSFORM_2D_H
+
+#include <cmath>
+
+#include <glm/vec2.hpp>
+
+// 2D affine transform, the 2x3 matrix of the SVG transform attribute and of
+// the canvas' setTransform():
+//
+//   | a c e |   | x |
+//   | b d f | * | y |
+//               | 1 |
+struct Transform2D
+{
+    float a = 1.0f;
+    float b = 0.0f;
+    float c = 0.0f;
+    float d = 1.0f;
+    float e = 0.0f;
+    float f = 0.0f;
+
+    static inline Transform2D matrix(float a, float b, float c, float d, float e, float f) {
+        return {a, b, c, d, e, f};
+    }
+
+    static inline Transform2D translate(float x, float y) {
+        return {1.0f, 0.0f, 0.0f, 1.0f, x, y};
+    }
+
+    static inline Transform2D scale(float x, float y) {
+        return {x, 0.0f, 0.0f, y, 0.0f, 0.0f};
+    }
+
+    // clockwise on screen, y pointing down.
+    static inline Transform2D rotate(float radians) {
+        float cosAngle = std::cos(radians);
+        float sinAngle = std::sin(radians);
+        return {cosAngle, sinAngle, -sinAngle, cosAngle, 0.0f, 0.0f};
+    }
+
+    static inline Transform2D skewX(float radians) {
+        return {1.0f, 0.0f, std::tan(radians), 1.0f, 0.0f, 0.0f};
+    }
+
+    static inline Transform2D skewY(float radians) {
+        return {1.0f, std::tan(radians), 0.0f, 1.0f, 0.0f, 0.0f};
+    }
+
+    // 'other' first, then this transform. SVG's "translate(...) scale(...)"
+    // is translate * scale.
+    inline Transform2D operator*(const Transform2D &other) const {
+        return {a * other.a + c * other.b,
+                b * other.a + d * other.b,
+                a * other.c + c * other.d,
+                b * other.c + d * other.d,
+                a * other.e + c * other.f + e,
+                b * other.e + d * other.f + f};
+    }
+
+    inline bool operator==(const Transform2D &other) const {
+        return a == other.a && b == other.b && c == other.c && d == other.d && e == other.e && f == other.f;
+    }
+
+    inline bool operator!=(const Transform2D &other) const {
+        return !(*this == other);
+    }
+
+    inline glm::vec2 apply(glm::vec2 point) const {
+        return glm::vec2(a * point.x + c * point.y + e, b * point.x + d * point.y + f);
+    }
+
+    // without the translation, for directions and axes.
+    inline glm::vec2 applyToVector(glm::vec2 vector) const {
+        return glm::vec2(a * vector.x + c * vector.y, b * vector.x + d * vector.y);
+    }
+
+    inline float determinant() const {
+        return a * d - b * c;
+    }
+
+    // false, leaving 'result' untouched, if the transform collapses the plane
+    // to a line or a point.
+    inline bool inverse(Transform2D &result) const {
+        float det = determinant();
+        if (det == 0.0f || !std::isfinite(det)) {
+            return false;
+        }
+        float invDet = 1.0f / det;
+        result = {d * invDet, -b * invDet, -c * invDet, a * invDet,
+                  (c * f - d * e) * invDet, (b * e - a * f) * invDet};
+        return true;
+    }
+
+    // Largest factor a length can be scaled by: the spectral norm of the
+    // linear part, i.e. the larger semi-axis of the ellipse a unit circle
+    // becomes.
+    inline float maxScale() const {
+        return maxScale(glm::vec2(a, b), glm::vec2(c, d));
+    }
+
+    // same, for the linear map whose columns are 'u' and 'v'.
+    static inline float maxScale(glm::vec2 u, glm::vec2 v) {
+        float uu = u.x * u.x + u.y * u.y;
+        float vv = v.x * v.x + v.y * v.y;
+        float uv = u.x * v.x + u.y * v.y;
+        float difference = uu - vv;
+        return std::sqrt(0.5f * (uu + vv + std::sqrt(difference * difference + 4.0f * uv * uv)));
+    }
+
+    // Scale of areas, as a length factor. Used for the stroke width, which a
+    // non-uniform transform would otherwise vary along the outline.
+    inline float averageScale() const {
+        return std::sqrt(std::abs(determinant()));
+    }
+};
+
+#endif // TRANSFORM_2D_H
@@ -1,22 +1,29 @@
 #include "VectorGraphic.h"
 
-#include <fstream>
-#include <sstream>
-
-#define MPE_POLY2TRI_IMPLEMENTATION
-#include <MPE_fastpoly2tri.h>
-
-
-
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+
+// The headless build (see VectorGraphicViewerBench) doesn't link against SDL.
+#ifdef VECTOR_GRAPHIC_HEADLESS
+#include <cstdio>
+#define VG_LOG_CRITICAL(...) do { fprintf(stderr, __VA_ARGS__); fputc('\n', stderr); } while((void)0, 0)
+#else
 #include <SDL2/SDL.h>
+#define VG_LOG_CRITICAL(...) SDL_LogCritical(0, __VA_ARGS__)
+#endif
 
 #include <glm/glm.hpp>
 #include <glm/gtc/epsilon.hpp>
 #include <glm/gtc/constants.hpp>
 #include <glm/gtx/exterior_product.hpp>
 
+#include "FillTessellator.h"
+#include "MappedFile.h"
+#include "PerfectHash.h"
 #include "StringUtils.h"
-#include "ViewerApp.h"
+#include "TessellationStats.h"
+#include "XmlStreamReader.h"
 
 #include <rapidxml/rapidxml.hpp>
 
@@ -24,6 +31,10 @@ using namespace rapidxml;
 
 static constexpr float distTol = 0.01f; // tolerance for points being added too closely from each other
 static constexpr size_t BEZIER_RECURSION_LIMIT = 128;
+static constexpr uint32_t BEZIER_SEGMENT_LIMIT = 512;
+static constexpr uint32_t ARC_SEGMENT_LIMIT = 1024;
+
+CurveFlattener Path2D::defaultCurveFlattener = CurveFlattener::recursive;
 
 namespace detail
 {
@@ -53,6 +64,18 @@ namespace detail
     }
 
 
+    // appends without checking for duplicates. Only use it for points that are
+    // known to be apart from each other.
+    inline void pushPoint(std::vector<glm::vec2> &points, glm::vec2 pos, PointProperties = PointProperties::none)
+    {
+        points.push_back(pos);
+    }
+
+    inline void pushPoint(std::vector<ContourPoint> &points, glm::vec2 pos, PointProperties type)
+    {
+        points.push_back({pos, {}, {}, 0.0f, type});
+    }
+
     // based of http://antigrain.com/__code/src/agg_curves.cpp.html by Maxim Shemanarev
 
 
@@ -202,9 +225,143 @@ namespace detail
         addPoint(points, glm::vec2(x4, y4), PointProperties::corner);
     }
 
-    template <typename PointArray>
-    inline void arc(PointArray &points, glm::vec2 center, float radius,
-                    float startAngle, float endAngle, bool anticlockwise, float tesselationTolerance)
+    // The recursive flattener compares squared distances against the
+    // tolerance, the analytic ones want a plain distance.
+    inline float distanceTolerance(float tesselationTolerance)
+    {
+        return glm::sqrt(tesselationTolerance);
+    }
+
+    // Wang's formula: the number of line segments needed to keep a cubic bezier
+    // within 'distanceTolerance' of its polyline, bounded by its largest second
+    // difference.
+    inline uint32_t cubicSegmentCount(float x1, float y1,
+                                      float x2, float y2,
+                                      float x3, float y3,
+                                      float x4, float y4,
+                                      float distanceTolerance)
+    {
+        float ddx0 = x1 - 2.0f * x2 + x3;
+        float ddy0 = y1 - 2.0f * y2 + y3;
+        float ddx1 = x2 - 2.0f * x3 + x4;
+        float ddy1 = y2 - 2.0f * y3 + y4;
+        float dd = glm::sqrt(glm::max(ddx0 * ddx0 + ddy0 * ddy0, ddx1 * ddx1 + ddy1 * ddy1));
+
+        float segmentCount = glm::ceil(glm::sqrt(0.75f * dd / distanceTolerance));
+        return static_cast<uint32_t>(glm::clamp(segmentCount, 1.0f, static_cast<float>(BEZIER_SEGMENT_LIMIT)));
+    }
+
+    // Evaluates the cubic at 'segmentCount' evenly spaced steps using forward
+    // differencing, so each point costs 6 additions.
+    template<typename PointArray>
+    inline void forwardDifferenceBezierTo(PointArray &points,
+                                          float x1, float y1,
+                                          float x2, float y2,
+                                          float x3, float y3,
+                                          float x4, float y4,
+                                          float tesselationTolerance)
+    {
+        uint32_t segmentCount = cubicSegmentCount(x1, y1, x2, y2, x3, y3, x4, y4, distanceTolerance(tesselationTolerance));
+
+        // polynomial coefficients of B(t) = a*t^3 + b*t^2 + c*t + p1
+        glm::vec2 a(-x1 + 3.0f * (x2 - x3) + x4, -y1 + 3.0f * (y2 - y3) + y4);
+        glm::vec2 b(3.0f * (x1 - 2.0f * x2 + x3), 3.0f * (y1 - 2.0f * y2 + y3));
+        glm::vec2 c(3.0f * (x2 - x1), 3.0f * (y2 - y1));
+
+        float h = 1.0f / static_cast<float>(segmentCount);
+        float h2 = h * h;
+        float h3 = h2 * h;
+
+        glm::vec2 pos(x1, y1);
+        glm::vec2 d1 = a * h3 + b * h2 + c * h;
+        glm::vec2 d3 = a * (6.0f * h3);
+        glm::vec2 d2 = d3 + b * (2.0f * h2);
+
+        points.reserve(points.size() + segmentCount);
+        for (uint32_t i = 1; i < segmentCount; ++i)
+        {
+            pos += d1;
+            d1 += d2;
+            d2 += d3;
+            pushPoint(points, pos, PointProperties::none);
+        }
+
+        addPoint(points, glm::vec2(x4, y4), PointProperties::corner);
+    }
+
+    template<typename PointArray>
+    inline void bezierTo(PointArray &points,
+                            float x1, float y1,
+                            float x2, float y2,
+                            float x3, float y3,
+                            float x4, float y4,
+                            float tesselationTolerance,
+                            CurveFlattener curveFlattener)
+    {
+        switch (curveFlattener)
+        {
+            case CurveFlattener::forwardDifferencing:
+                forwardDifferenceBezierTo(points, x1, y1, x2, y2, x3, y3, x4, y4, tesselationTolerance);
+                break;
+            case CurveFlattener::recursive:
+            default:
+                bezierTo(points, x1, y1, x2, y2, x3, y3, x4, y4, tesselationTolerance);
+                break;
+        }
+    }
+
+    // The distance between a quadratic bezier and its chords is at most
+    // |p1 - 2*p2 + p3| / (4*n^2) when split in n even steps, which gives the
+    // exact number of segments needed for 'distanceTolerance'.
+    inline uint32_t quadraticSegmentCount(float x1, float y1,
+                                          float x2, float y2,
+                                          float x3, float y3,
+                                          float distanceTolerance)
+    {
+        float ddx = x1 - 2.0f * x2 + x3;
+        float ddy = y1 - 2.0f * y2 + y3;
+        float dd = glm::sqrt(ddx * ddx + ddy * ddy);
+
+        float segmentCount = glm::ceil(glm::sqrt(0.25f * dd / distanceTolerance));
+        return static_cast<uint32_t>(glm::clamp(segmentCount, 1.0f, static_cast<float>(BEZIER_SEGMENT_LIMIT)));
+    }
+
+    // Flattens a quadratic bezier directly instead of elevating it to a cubic.
+    // The second difference is constant so each point costs 4 additions.
+    template<typename PointArray>
+    inline void quadraticBezierTo(PointArray &points,
+                                  float x1, float y1,
+                                  float x2, float y2,
+                                  float x3, float y3,
+                                  float tesselationTolerance)
+    {
+        uint32_t segmentCount = quadraticSegmentCount(x1, y1, x2, y2, x3, y3, distanceTolerance(tesselationTolerance));
+
+        // polynomial coefficients of B(t) = a*t^2 + b*t + p1
+        glm::vec2 a(x1 - 2.0f * x2 + x3, y1 - 2.0f * y2 + y3);
+        glm::vec2 b(2.0f * (x2 - x1), 2.0f * (y2 - y1));
+
+        float h = 1.0f / static_cast<float>(segmentCount);
+        float h2 = h * h;
+
+        glm::vec2 pos(x1, y1);
+        glm::vec2 d1 = a * h2 + b * h;
+        glm::vec2 d2 = a * (2.0f * h2);
+
+        points.reserve(points.size() + segmentCount);
+        for (uint32_t i = 1; i < segmentCount; ++i)
+        {
+            pos += d1;
+            d1 += d2;
+            pushPoint(points, pos, PointProperties::none);
+        }
+
+        addPoint(points, glm::vec2(x3, y3), PointProperties::corner);
+    }
+
+    // Angle swept from 'startAngle' to 'endAngle', following the canvas rules:
+    // negative when anticlockwise, and clamped to a full turn.
+    inline float arcSweep(float startAngle, float endAngle, bool anticlockwise)
     {
         float deltaAngle = endAngle - startAngle;
 
@@ -237,37 +394,146 @@ namespace detail
             }
         }
 
-        int32_t segmentCount = static_cast<int32_t>(glm::ceil( glm::abs(deltaAngle) / glm::half_pi<float>()));
+        return deltaAngle;
+    }
+
+    // Flattens an elliptical arc directly. The angular step is the largest one
+    // whose chord stays within 'distanceTolerance' of a circle of the larger
+    // radius, and the points are produced by rotating a unit vector by that
+    // step, so cos() and sin() are only called for the start and end points.
+    // An affine transform maps the ellipse to another one, so 'transform' is
+    // applied to its center and axes rather than to every point.
+    template <typename PointArray>
+    inline void ellipse(PointArray &points, glm::vec2 center, float radiusX, float radiusY, float rotation,
+                        float startAngle, float endAngle, bool anticlockwise, float tesselationTolerance,
+                        const Transform2D &transform = Transform2D())
+    {
+        float deltaAngle = arcSweep(startAngle, endAngle, anticlockwise);
+
+        glm::vec2 axisX(glm::cos(rotation), glm::sin(rotation));
+        glm::vec2 axisY(-axisX.y, axisX.x);
+        center = transform.apply(center);
+        axisX = transform.applyToVector(axisX * radiusX);
+        axisY = transform.applyToVector(axisY * radiusY);
+
+        glm::vec2 dir(glm::cos(startAngle), glm::sin(startAngle));
+        addPoint(points, center + axisX * dir.x + axisY * dir.y, PointProperties::corner);
+
+        // sagitta of a chord spanning 'step' radians: r * (1 - cos(step / 2)).
+        // The axes aren't perpendicular anymore after a skew.
+        float radius = Transform2D::maxScale(axisX, axisY);
+        float step = glm::half_pi<float>();
+        if (radius > distTol)
+        {
+            float cosHalfStep = glm::clamp(1.0f - distanceTolerance(tesselationTolerance) / radius, -1.0f, 1.0f);
+            step = glm::clamp(2.0f * glm::acos(cosHalfStep), glm::epsilon<float>(), glm::half_pi<float>());
+        }
+
+        float segmentCount = glm::clamp(glm::ceil(glm::abs(deltaAngle) / step), 1.0f, static_cast<float>(ARC_SEGMENT_LIMIT));
+        uint32_t segments = static_cast<uint32_t>(segmentCount);
 
-        float midAngle = (deltaAngle / segmentCount) * 0.5f;
-        float tangentFactor = glm::abs(4.0f / 3.0f * (1.0f - glm::cos(midAngle)) / glm::sin(midAngle));
+        float segmentAngle = deltaAngle / segmentCount;
+        float cosStep = glm::cos(segmentAngle);
+        float sinStep = glm::sin(segmentAngle);
 
-        if (anticlockwise)
+        points.reserve(points.size() + segments);
+        for (uint32_t segment = 1; segment < segments; ++segment)
         {
-            tangentFactor = -tangentFactor;
+            dir = glm::vec2(dir.x * cosStep - dir.y * sinStep, dir.x * sinStep + dir.y * cosStep);
+            pushPoint(points, center + axisX * dir.x + axisY * dir.y, PointProperties::none);
         }
 
-        glm::vec2 dir(glm::cos(startAngle), glm::sin(startAngle));
-        glm::vec2 prev = center + dir * radius;
-        glm::vec2 prevTan(-dir.y * tangentFactor * radius, dir.x * tangentFactor * radius);
-        addPoint(points, prev, PointProperties::corner);
+        // computed directly so the rotation error doesn't accumulate into the end point.
+        float angle = startAngle + deltaAngle;
+        dir = glm::vec2(glm::cos(angle), glm::sin(angle));
+        addPoint(points, center + axisX * dir.x + axisY * dir.y, PointProperties::corner);
+    }
+
+    template <typename PointArray>
+    inline void arc(PointArray &points, glm::vec2 center, float radius,
+                    float startAngle, float endAngle, bool anticlockwise, float tesselationTolerance,
+                    const Transform2D &transform = Transform2D())
+    {
+        ellipse(points, center, radius, radius, 0.0f, startAngle, endAngle, anticlockwise, tesselationTolerance, transform);
+    }
+
+    struct EllipseArc
+    {
+        glm::vec2 center;
+        glm::vec2 radius;
+        float rotation;
+        float startAngle;
+        float endAngle;
+        bool anticlockwise;
+    };
 
-        for (int32_t segment = 1; segment <= segmentCount; ++segment)
+    // Converts an SVG arc from its endpoint parameterization (the 'A' command)
+    // to the center one used by ellipse(). See
+    // https://www.w3.org/TR/SVG11/implnote.html#ArcConversionEndpointToCenter
+    // Returns false when the arc degenerates to a straight line.
+    inline bool arcEndpointToCenter(glm::vec2 p1, glm::vec2 p2, float rx, float ry, float xAxisRotation,
+                                    bool largeArc, bool sweep, EllipseArc &arc)
+    {
+        rx = glm::abs(rx);
+        ry = glm::abs(ry);
+        if (rx < glm::epsilon<float>() || ry < glm::epsilon<float>() ||
+            glm::all(glm::epsilonEqual(p1, p2, glm::epsilon<float>())))
         {
-            float angle = startAngle + deltaAngle * (static_cast<float>(segment)/static_cast<float>(segmentCount));
-            dir = glm::vec2(glm::cos(angle), glm::sin(angle));
-            glm::vec2 pos = center + dir * radius;
-            glm::vec2 tan(-dir.y * tangentFactor * radius, dir.x * tangentFactor * radius);
+            return false;
+        }
 
-            bezierTo(points,
-                        prev.x, prev.y, // start point
-                        prev.x + prevTan.x, prev.y + prevTan.y, // control point 1
-                        pos.x - tan.x, pos.y - tan.y, // control point 2
-                        pos.x, pos.y, tesselationTolerance); // end point
+        float cosRotation = glm::cos(xAxisRotation);
+        float sinRotation = glm::sin(xAxisRotation);
 
-            prev = pos;
-            prevTan = tan;
+        // step 1: midpoint in the ellipse's frame
+        glm::vec2 half = (p1 - p2) * 0.5f;
+        glm::vec2 p(cosRotation * half.x + sinRotation * half.y,
+                    -sinRotation * half.x + cosRotation * half.y);
+
+        // scale the radii up if they can't reach both points
+        float lambda = (p.x * p.x) / (rx * rx) + (p.y * p.y) / (ry * ry);
+        if (lambda > 1.0f)
+        {
+            float scale = glm::sqrt(lambda);
+            rx *= scale;
+            ry *= scale;
+        }
+
+        // step 2: center in the ellipse's frame
+        float rx2 = rx * rx;
+        float ry2 = ry * ry;
+        float denominator = rx2 * p.y * p.y + ry2 * p.x * p.x;
+        float coefficient = glm::sqrt(glm::max(0.0f, (rx2 * ry2 - denominator) / denominator));
+        if (largeArc == sweep)
+        {
+            coefficient = -coefficient;
+        }
+        glm::vec2 c(coefficient * rx * p.y / ry, -coefficient * ry * p.x / rx);
+
+        // step 3: center in user space
+        arc.center = glm::vec2(cosRotation * c.x - sinRotation * c.y,
+                               sinRotation * c.x + cosRotation * c.y) + (p1 + p2) * 0.5f;
+
+        // step 4: angles
+        glm::vec2 u((p.x - c.x) / rx, (p.y - c.y) / ry);
+        glm::vec2 v((-p.x - c.x) / rx, (-p.y - c.y) / ry);
+        float startAngle = glm::atan(u.y, u.x);
+        float deltaAngle = glm::atan(u.x * v.y - u.y * v.x, u.x * v.x + u.y * v.y);
+        if (!sweep && deltaAngle > 0.0f)
+        {
+            deltaAngle -= glm::two_pi<float>();
+        }
+        else if (sweep && deltaAngle < 0.0f)
+        {
+            deltaAngle += glm::two_pi<float>();
         }
+
+        arc.radius = glm::vec2(rx, ry);
+        arc.rotation = xAxisRotation;
+        arc.startAngle = startAngle;
+        arc.endAngle = startAngle + deltaAngle;
+        arc.anticlockwise = !sweep;
+        return true;
     }
 
     inline float distPtSeg(const glm::vec2 &c, const glm::vec2 &p, const glm::vec2 &q)
@@ -289,30 +555,32 @@ namespace detail
         return glm::dot(pc, pc);
     }
 
+    // p0, p1 and p2 are before 'transform', the points are added after it.
     template <typename PointArray>
-    inline void arcTo(PointArray &points, glm::vec2 p0, glm::vec2 p1, glm::vec2 p2, float radius, float tesselationTolerance)
+    inline void arcTo(PointArray &points, glm::vec2 p0, glm::vec2 p1, glm::vec2 p2, float radius, float tesselationTolerance,
+                      const Transform2D &transform = Transform2D())
     {
         if (glm::all(glm::epsilonEqual(p0, p1, distTol)))
         {
-            addPoint(points, p1, PointProperties::corner);
+            addPoint(points, transform.apply(p1), PointProperties::corner);
             return;
         }
 
         if (glm::all(glm::epsilonEqual(p1, p2, distTol)))
         {
-            addPoint(points, p1, PointProperties::corner);
+            addPoint(points, transform.apply(p1), PointProperties::corner);
             return;
         }
 
         if (distPtSeg(p1, p0, p2) < (distTol * distTol))
         {
-            addPoint(points, p1, PointProperties::corner);
+            addPoint(points, transform.apply(p1), PointProperties::corner);
             return;
         }
 
         if (radius < distTol)
         {
-            addPoint(points, p1, PointProperties::corner);
+            addPoint(points, transform.apply(p1), PointProperties::corner);
             return;
         }
 
@@ -323,7 +591,7 @@ namespace detail
 
         if (d > 10000.0f)
         {
-            addPoint(points, p1, PointProperties::corner);
+            addPoint(points, transform.apply(p1), PointProperties::corner);
             return;
         }
 
@@ -349,557 +617,1096 @@ namespace detail
             anticlockwise = true;
         }
 
-        arc(points, c, radius, a0, a1, anticlockwise, tesselationTolerance);
+        arc(points, c, radius, a0, a1, anticlockwise, tesselationTolerance, transform);
+    }
+
+    inline glm::vec2 position(const glm::vec2 &point) { return point; }
+    inline glm::vec2 position(const ContourPoint &point) { return point.pos; }
+
+    // True if the contour (implicitly closed) turns the same way at every
+    // corner and only goes around once, so a fan from any of its points covers
+    // it exactly. Collinear points are fine, a star that turns one way all along
+    // is caught by its edges changing horizontal or vertical direction more than
+    // twice.
+    template <typename Point>
+    bool isConvex(const std::vector<Point> &points)
+    {
+        size_t count = points.size();
+        if (count < 3) {
+            return false;
+        }
+
+        float turn = 0.0f;
+        int xFlips = 0, yFlips = 0;
+        float prevDirX = 0.0f, prevDirY = 0.0f;
+        glm::vec2 prevDir = position(points[0]) - position(points[count-1]);
+        for (size_t i = 0; i < count; ++i) {
+            glm::vec2 dir = position(points[i+1 < count ? i+1 : 0]) - position(points[i]);
+
+            float cross = prevDir.x * dir.y - prevDir.y * dir.x;
+            if (cross != 0.0f) {
+                if (turn == 0.0f) {
+                    turn = cross;
+                } else if ((cross > 0.0f) != (turn > 0.0f)) {
+                    return false;
+                }
+            }
+
+            if (dir.x != 0.0f) {
+                if (prevDirX != 0.0f && (dir.x > 0.0f) != (prevDirX > 0.0f) && ++xFlips > 2) {
+                    return false;
+                }
+                prevDirX = dir.x;
+            }
+            if (dir.y != 0.0f) {
+                if (prevDirY != 0.0f && (dir.y > 0.0f) != (prevDirY > 0.0f) && ++yFlips > 2) {
+                    return false;
+                }
+                prevDirY = dir.y;
+            }
+
+            prevDir = dir;
+        }
+
+        // a contour without any turn is a line, there is nothing to fill.
+        return turn != 0.0f;
+    }
+
+    // appends a convex contour to the mesh as a triangle fan around its first
+    // point. A fan with more vertices than a batch holds is split in several,
+    // each one starting with the first point again and with the last point of
+    // the previous one.
+    template <typename Point>
+    void appendTriangleFan(Mesh &mesh, const std::vector<Point> &points, const Color &color)
+    {
+        if (points.size() < 3) {
+            return;
+        }
+
+        glm::vec2 center = position(points[0]);
+        size_t first = 1;
+        do {
+            size_t count = std::min(points.size() - first, Mesh::MAX_BATCH_VERTEX_COUNT - 1);
+            uint16_t offset = mesh.beginVertices(count + 1);
+
+            mesh.vertices.push_back({{center.x, center.y, 0.0f}, color});
+            for (size_t i = first; i < first + count; ++i) {
+                glm::vec2 pos = position(points[i]);
+                mesh.vertices.push_back({{pos.x, pos.y, 0.0f}, color});
+            }
+
+            for (size_t i = 1; i < count; ++i) {
+                mesh.indices.push_back(offset);
+                mesh.indices.push_back(static_cast<uint16_t>(offset+i));
+                mesh.indices.push_back(static_cast<uint16_t>(offset+i+1));
+            }
+
+            first += count - 1;
+        } while (first + 1 < points.size());
+    }
+}
+
+bool MeshView::isValid() const {
+    if (batchCount == 0) {
+        return vertexCount == 0 && indexCount == 0;
+    }
+    for (size_t batch = 0; batch < batchCount; ++batch) {
+        size_t vertexOffset = batches[batch].vertexOffset;
+        size_t vertexEnd = batch + 1 < batchCount ? batches[batch + 1].vertexOffset : vertexCount;
+        size_t indexOffset = batches[batch].indexOffset;
+        size_t indexEnd = batch + 1 < batchCount ? batches[batch + 1].indexOffset : indexCount;
+        if (vertexEnd < vertexOffset || vertexEnd > vertexCount || indexEnd < indexOffset || indexEnd > indexCount ||
+            vertexEnd - vertexOffset > Mesh::MAX_BATCH_VERTEX_COUNT) {
+            return false;
+        }
+        for (size_t i = indexOffset; i < indexEnd; ++i) {
+            if (indices[i] >= vertexEnd - vertexOffset) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void Mesh::append(const Mesh &mesh) {
+    append(mesh.view());
+}
+
+void Mesh::append(const MeshView &mesh) {
+    for (size_t batch = 0; batch < mesh.batchCount; ++batch) {
+        size_t vertexOffset = mesh.batches[batch].vertexOffset;
+        size_t vertexEnd = batch + 1 < mesh.batchCount ? mesh.batches[batch + 1].vertexOffset : mesh.vertexCount;
+        size_t indexOffset = mesh.batches[batch].indexOffset;
+        size_t indexEnd = batch + 1 < mesh.batchCount ? mesh.batches[batch + 1].indexOffset : mesh.indexCount;
+
+        uint16_t offset = beginVertices(vertexEnd - vertexOffset);
+        vertices.insert(vertices.end(), mesh.vertices + vertexOffset, mesh.vertices + vertexEnd);
+        for (size_t i = indexOffset; i < indexEnd; ++i) {
+            indices.push_back(offset + mesh.indices[i]);
+        }
     }
 }
 
 std::vector<Path2D> Path2D::fromSVGFile(const std::string &filePath, Unit unit, float dpi, float tesselationTolerance)
 {
-    std::ifstream ifs;
-    ifs.open(filePath);
-    if (!ifs.is_open())
+    VG_PROFILE_PHASE(parse);
+
+    // mapped copy-on-write and parsed in place, then unmapped as soon as the
+    // paths are built.
+    MappedFile file;
+    if (!file.open(filePath))
     {
-        SDL_LogCritical(0, "Could not open %s", filePath.c_str());
+        VG_LOG_CRITICAL("Could not open %s", filePath.c_str());
         return {};
     }
 
-    std::stringstream svgStream;
-    svgStream << ifs.rdbuf();
+    return fromSVGBuffer(file.data(), unit, dpi, tesselationTolerance);
+}
+
+enum class SVGElement : uint8_t
+{
+    svg,
+    g,
+    path,
+    circle,
+    count
+};
 
-    std::string svgBuffer = svgStream.str();
+enum class SVGAttribute : uint8_t
+{
+    id,
+    fill,
+    fillRule,
+    stroke,
+    strokeWidth,
+    strokeMiterLimit,
+    strokeLineJoin,
+    strokeLineCap,
+    d,
+    cx,
+    cy,
+    r,
+    transform,
+    count
+};
 
-    ifs.close();
+// in the order of the enums above
+static constexpr PerfectHash<static_cast<size_t>(SVGElement::count), 8> svgElements({
+    "svg", "g", "path", "circle",
+});
 
-    return fromSVGBuffer(svgBuffer, unit, dpi, tesselationTolerance);
+static constexpr PerfectHash<static_cast<size_t>(SVGAttribute::count), 32> svgAttributes({
+    "id", "fill", "fill-rule", "stroke", "stroke-width", "stroke-miterlimit",
+    "stroke-linejoin", "stroke-linecap", "d", "cx", "cy", "r", "transform",
+});
 
+inline SVGElement svgElement(std::string_view name) {
+    return static_cast<SVGElement>(svgElements.find(name));
 }
 
-struct SVGState {
+// Unsupported elements and attributes tend to repeat throughout a document
+// (e.g. a transform on every group), only the first ones are logged.
+struct SVGWarnings {
+    static constexpr uint32_t MAX_LOGGED = 8;
+
+    uint32_t count = 0;
+
+    inline bool shouldLog() {
+        return count++ < MAX_LOGGED;
+    }
+
+    // warnings of the document being parsed on the calling thread.
+    static inline SVGWarnings &current() {
+        static thread_local SVGWarnings warnings;
+        return warnings;
+    }
+};
+
+#define SVG_WARNING(...) do { if (SVGWarnings::current().shouldLog()) VG_LOG_CRITICAL(__VA_ARGS__); } while((void)0, 0)
 
-    std::string id;
+// Resets the warnings when a document starts, and logs how many were left out
+// once it is done.
+class SVGWarningScope
+{
+public:
+    inline SVGWarningScope() {
+        SVGWarnings::current().count = 0;
+    }
+
+    inline ~SVGWarningScope() {
+        uint32_t count = SVGWarnings::current().count;
+        if (count > SVGWarnings::MAX_LOGGED) {
+            VG_LOG_CRITICAL("%u more unsupported SVG elements or attributes ignored", count - SVGWarnings::MAX_LOGGED);
+        }
+    }
+};
 
+// Presentation attributes, inherited from the enclosing groups. Trivially
+// copyable, so entering a group is a plain copy.
+struct SVGStyle {
     Color fillStyle = Transparent;
     Color strokeStyle = Transparent;
     float lineWidth = 1.0f;
     float miterLimit = 10.0f;
     LineJoin lineJoin = LineJoin::miter;
     LineCap lineCap = LineCap::butt;
+    FillRule fillRule = FillRule::nonZero;
+
+    // concatenated down from the outermost group.
+    Transform2D transform;
+};
+
+// Parses an SVG transform list such as "translate(10,20) rotate(45 5 5)".
+// Returns false on a syntax error, 'result' is then left unchanged.
+bool parseSvgTransform(const char *value, size_t size, Transform2D &result) {
+    const char *cur = value;
+    const char *end = value + size;
+
+    auto skipSeparators = [&]() {
+        while (cur < end && (*cur == ' ' || *cur == ',' || *cur == '\t' || *cur == '\n' || *cur == '\r')) ++cur;
+    };
+
+    Transform2D transform;
+    for (skipSeparators(); cur < end; skipSeparators()) {
+        const char *name = cur;
+        while (cur < end && ((*cur >= 'a' && *cur <= 'z') || (*cur >= 'A' && *cur <= 'Z'))) ++cur;
+        std::string_view function(name, cur - name);
+
+        while (cur < end && *cur == ' ') ++cur;
+        if (cur == end || *cur != '(') {
+            return false;
+        }
+        ++cur;
+
+        float params[6];
+        size_t paramCount = 0;
+        for (;;) {
+            skipSeparators();
+            if (cur < end && *cur == ')') {
+                ++cur;
+                break;
+            }
+            if (paramCount == 6 || !parseNumber(cur, end, params[paramCount])) {
+                return false;
+            }
+            ++paramCount;
+        }
+
+        if (function == "matrix" && paramCount == 6) {
+            transform = transform * Transform2D::matrix(params[0], params[1], params[2], params[3], params[4], params[5]);
+        } else if (function == "translate" && (paramCount == 1 || paramCount == 2)) {
+            transform = transform * Transform2D::translate(params[0], paramCount == 2 ? params[1] : 0.0f);
+        } else if (function == "scale" && (paramCount == 1 || paramCount == 2)) {
+            transform = transform * Transform2D::scale(params[0], paramCount == 2 ? params[1] : params[0]);
+        } else if (function == "rotate" && (paramCount == 1 || paramCount == 3)) {
+            Transform2D rotation = Transform2D::rotate(glm::radians(params[0]));
+            if (paramCount == 3) {
+                // around (cx, cy)
+                rotation = Transform2D::translate(params[1], params[2]) * rotation * Transform2D::translate(-params[1], -params[2]);
+            }
+            transform = transform * rotation;
+        } else if (function == "skewX" && paramCount == 1) {
+            transform = transform * Transform2D::skewX(glm::radians(params[0]));
+        } else if (function == "skewY" && paramCount == 1) {
+            transform = transform * Transform2D::skewY(glm::radians(params[0]));
+        } else {
+            return false;
+        }
+    }
+
+    result = transform;
+    return true;
+}
+
+// Parses a number attribute such as stroke-width="2" or r="10px", ignoring
+// the unit. Returns false if it doesn't start with a number, 'result' is then
+// left unchanged.
+bool parseSvgNumber(const char *value, size_t size, float &result) {
+    const char *cur = value;
+    const char *end = value + size;
+    while (cur < end && (*cur == ' ' || *cur == '\t' || *cur == '\n' || *cur == '\r')) ++cur;
+    return parseNumber(cur, end, result);
+}
+
+// Attributes of a single element, not inherited. The strings point into the
+// document being parsed.
+struct SVGGeometry {
+    std::string_view id;
 
     // from path
-    std::string d;
+    std::string_view d;
 
     // from circle
     float cx = 0.0f;
     float cy = 0.0f;
     float r = 0.0f;
+};
 
-    inline void apply(xml_node<> *node) {
-        for(xml_attribute<> *attr = node->first_attribute(); attr != nullptr; attr = attr->next_attribute()) {
-            if (strncmp(attr->name(), "id", 3) == 0) {
-                id = attr->value();
-            } else if (strncmp(attr->name(), "fill", 5) == 0) {
-                fillStyle = attr->value();
-            } else if (strncmp(attr->name(), "stroke", 7) == 0) {
-                strokeStyle = attr->value();
-            } else if (strncmp(attr->name(), "stroke-width", 13) == 0) {
-                lineWidth = atof(attr->value());
-            } else if (strncmp(attr->name(), "stroke-miterlimit", 18) == 0) {
-                miterLimit = atof(attr->value());
-            } else if (strncmp(attr->name(), "stroke-linejoin", 16) == 0) {
-                if (strncmp(attr->value(), "bevel", 6) == 0) {
-                    lineJoin = LineJoin::bevel;
-
-                } else if (strncmp(attr->value(), "round", 6) == 0) {
-                    lineJoin = LineJoin::round;
-
-                } else if (strncmp(attr->value(), "miter", 6) == 0) {
-                    lineJoin = LineJoin::miter;
-
-                }
-            } else if (strncmp(attr->name(), "stroke-linecap", 16) == 0) {
-                if (strncmp(attr->value(), "butt", 5) == 0) {
-                    lineCap = LineCap::butt;
-
-                } else if (strncmp(attr->value(), "round", 6) == 0) {
-                    lineCap = LineCap::round;
-
-                } else if (strncmp(attr->value(), "square", 7) == 0) {
-                    lineCap = LineCap::square;
-                }
-            } else if (strncmp(attr->name(), "d", 2) == 0) {
-                std::string value = attr->value();
-                d = trim(value);
-
-            } else if (strncmp(attr->name(), "cx", 3) == 0) {
-                cx = atof(attr->value());
-            } else if (strncmp(attr->name(), "cy", 3) == 0) {
-                cy = atof(attr->value());
-            } else if (strncmp(attr->name(), "r", 2) == 0) {
-                r = atof(attr->value());
+void applySvgAttribute(const char *element, std::string_view name, const char *value, size_t valueSize, SVGStyle &style, SVGGeometry &geometry) {
+    switch (static_cast<SVGAttribute>(svgAttributes.find(name))) {
+        case SVGAttribute::id:
+            geometry.id = std::string_view(value, valueSize);
+            break;
+        case SVGAttribute::fill:
+            style.fillStyle = Color(std::string_view(value, valueSize));
+            break;
+        case SVGAttribute::fillRule:
+            if (strcmp(value, "nonzero") == 0) {
+                style.fillRule = FillRule::nonZero;
+            } else if (strcmp(value, "evenodd") == 0) {
+                style.fillRule = FillRule::evenOdd;
+            }
+            break;
+        case SVGAttribute::stroke:
+            style.strokeStyle = Color(std::string_view(value, valueSize));
+            break;
+        case SVGAttribute::strokeWidth:
+            if (!parseSvgNumber(value, valueSize, style.lineWidth)) {
+                SVG_WARNING("Invalid SVG <%s> %.*s: '%s'", element, static_cast<int>(name.size()), name.data(), value);
+            }
+            break;
+        case SVGAttribute::strokeMiterLimit:
+            if (!parseSvgNumber(value, valueSize, style.miterLimit)) {
+                SVG_WARNING("Invalid SVG <%s> %.*s: '%s'", element, static_cast<int>(name.size()), name.data(), value);
+            }
+            break;
+        case SVGAttribute::strokeLineJoin:
+            if (strcmp(value, "bevel") == 0) {
+                style.lineJoin = LineJoin::bevel;
+            } else if (strcmp(value, "round") == 0) {
+                style.lineJoin = LineJoin::round;
+            } else if (strcmp(value, "miter") == 0) {
+                style.lineJoin = LineJoin::miter;
+            }
+            break;
+        case SVGAttribute::strokeLineCap:
+            if (strcmp(value, "butt") == 0) {
+                style.lineCap = LineCap::butt;
+            } else if (strcmp(value, "round") == 0) {
+                style.lineCap = LineCap::round;
+            } else if (strcmp(value, "square") == 0) {
+                style.lineCap = LineCap::square;
+            }
+            break;
+        case SVGAttribute::d:
+            geometry.d = std::string_view(value, valueSize);
+            break;
+        case SVGAttribute::cx:
+            if (!parseSvgNumber(value, valueSize, geometry.cx)) {
+                SVG_WARNING("Invalid SVG <%s> %.*s: '%s'", element, static_cast<int>(name.size()), name.data(), value);
+            }
+            break;
+        case SVGAttribute::cy:
+            if (!parseSvgNumber(value, valueSize, geometry.cy)) {
+                SVG_WARNING("Invalid SVG <%s> %.*s: '%s'", element, static_cast<int>(name.size()), name.data(), value);
+            }
+            break;
+        case SVGAttribute::r:
+            if (!parseSvgNumber(value, valueSize, geometry.r)) {
+                SVG_WARNING("Invalid SVG <%s> %.*s: '%s'", element, static_cast<int>(name.size()), name.data(), value);
+            }
+            break;
+        case SVGAttribute::transform: {
+            Transform2D transform;
+            if (parseSvgTransform(value, valueSize, transform)) {
+                style.transform = style.transform * transform;
             } else {
-                SDL_LogCritical(0, "Unsupported SVG <%s> Attribute '%s': '%s'", node->name(), attr->name(), attr->value());
+                SVG_WARNING("Invalid SVG <%s> transform: '%s'", element, value);
             }
+            break;
         }
+        default:
+            SVG_WARNING("Unsupported SVG <%s> Attribute '%.*s': '%s'", element, static_cast<int>(name.size()), name.data(), value);
+            break;
     }
-};
+}
+
+void applySvgAttributes(xml_node<> *node, SVGStyle &style, SVGGeometry &geometry) {
+    for (xml_attribute<> *attr = node->first_attribute(); attr != nullptr; attr = attr->next_attribute()) {
+        applySvgAttribute(node->name(), std::string_view(attr->name(), attr->name_size()), attr->value(), attr->value_size(), style, geometry);
+    }
+}
+
+void applySvgAttributes(const char *element, const std::vector<XmlStreamReader::Attribute> &attributes, SVGStyle &style, SVGGeometry &geometry) {
+    for (const XmlStreamReader::Attribute &attr : attributes) {
+        applySvgAttribute(element, attr.name, attr.value, strlen(attr.value), style, geometry);
+    }
+}
+
+void applySvgStyle(Path2D &path, const SVGStyle &style) {
+    path.fillStyle = style.fillStyle;
+    path.strokeStyle = style.strokeStyle;
+    path.lineJoin = style.lineJoin;
+    path.lineCap = style.lineCap;
+    path.miterLimit = style.miterLimit;
+    path.lineWidth = style.lineWidth;
+    path.fillRule = style.fillRule;
+    path.setTransform(style.transform);
+}
 
-void processSvgChildrenNodes(xml_node<> *node, std::vector<SVGState> &stateStack, std::vector<Path2D> &paths, float tesselationTolerance);
+void processSvgChildrenNodes(xml_node<> *node, const SVGStyle &style, std::vector<Path2D> &paths, float tesselationTolerance);
 
-void processSvgGroup(xml_node<> *groupNode, std::vector<SVGState> &stateStack, std::vector<Path2D> &paths, float tesselationTolerance) {
-    stateStack.push_back(stateStack.back());
-    SVGState &state = stateStack.back();
-    state.apply(groupNode);
-    processSvgChildrenNodes(groupNode, stateStack, paths, tesselationTolerance);
-    stateStack.pop_back();
+void processSvgGroup(xml_node<> *groupNode, const SVGStyle &parentStyle, std::vector<Path2D> &paths, float tesselationTolerance) {
+    SVGStyle style = parentStyle;
+    SVGGeometry geometry;
+    applySvgAttributes(groupNode, style, geometry);
+    processSvgChildrenNodes(groupNode, style, paths, tesselationTolerance);
 }
 
-void processSvgPath(xml_node<> *pathNode, std::vector<SVGState> &stateStack, std::vector<Path2D> &paths, float tesselationTolerance) {
-    stateStack.push_back(stateStack.back());
-    SVGState &state = stateStack.back();
-    state.apply(pathNode);
+void processSvgPath(xml_node<> *pathNode, const SVGStyle &parentStyle, std::vector<Path2D> &paths, float tesselationTolerance) {
+    SVGStyle style = parentStyle;
+    SVGGeometry geometry;
+    applySvgAttributes(pathNode, style, geometry);
 
-    paths.push_back(Path2D(tesselationTolerance, state.d));
-    auto &path = paths.back();
-    path.fillStyle = state.fillStyle;
-    path.strokeStyle = state.strokeStyle;
-    path.lineJoin = state.lineJoin;
-    path.lineCap = state.lineCap;
-    path.miterLimit = state.miterLimit;
-    path.lineWidth = state.lineWidth;
-    
-    stateStack.pop_back();
+    paths.push_back(Path2D(tesselationTolerance, geometry.d));
+    applySvgStyle(paths.back(), style);
 }
 
-void processSvgCircle(xml_node<> *circleNode, std::vector<SVGState> &stateStack, std::vector<Path2D> &paths, float tesselationTolerance) {
-    stateStack.push_back(stateStack.back());
-    SVGState &state = stateStack.back();
-    state.apply(circleNode);
+void processSvgCircle(xml_node<> *circleNode, const SVGStyle &parentStyle, std::vector<Path2D> &paths, float tesselationTolerance) {
+    SVGStyle style = parentStyle;
+    SVGGeometry geometry;
+    applySvgAttributes(circleNode, style, geometry);
 
     paths.push_back(Path2D(tesselationTolerance));
     auto &path = paths.back();
-    path.arc(state.cx, state.cy, state.r, 0.0f, M_PI * 2.0f, true);
-    path.fillStyle = state.fillStyle;
-    path.strokeStyle = state.strokeStyle;
-    path.lineJoin = state.lineJoin;
-    path.lineCap = state.lineCap;
-    path.miterLimit = state.miterLimit;
-    path.lineWidth = state.lineWidth;
-    
-    stateStack.pop_back();
+    path.arc(geometry.cx, geometry.cy, geometry.r, 0.0f, glm::two_pi<float>(), true);
+    applySvgStyle(path, style);
 }
 
-void processSvgChildrenNodes(xml_node<> *node, std::vector<SVGState> &stateStack, std::vector<Path2D> &paths, float tesselationTolerance) {
+void processSvgChildrenNodes(xml_node<> *node, const SVGStyle &style, std::vector<Path2D> &paths, float tesselationTolerance) {
     for (xml_node<> *childNode = node->first_node(); childNode != nullptr; childNode = childNode->next_sibling()) {
-        if (strncmp(childNode->name(), "g", 2) == 0) {
-            processSvgGroup(childNode, stateStack, paths, tesselationTolerance);
-        } else if (strncmp(childNode->name(), "path", 5) == 0) {
-            processSvgPath(childNode, stateStack, paths, tesselationTolerance);
-        } else if (strncmp(childNode->name(), "circle", 5) == 0) {
-            processSvgCircle(childNode, stateStack, paths, tesselationTolerance);
-        } else {
-            SDL_LogCritical(0, "Unsupported SVG node <%s>", childNode->name());
+        switch (svgElement(std::string_view(childNode->name(), childNode->name_size()))) {
+            case SVGElement::g:
+                processSvgGroup(childNode, style, paths, tesselationTolerance);
+                break;
+            case SVGElement::path:
+                processSvgPath(childNode, style, paths, tesselationTolerance);
+                break;
+            case SVGElement::circle:
+                processSvgCircle(childNode, style, paths, tesselationTolerance);
+                break;
+            default:
+                SVG_WARNING("Unsupported SVG node <%s>", childNode->name());
+                break;
         }
     }
 }
 
 std::vector<Path2D> Path2D::fromSVGBuffer(const std::string &buffer, Unit unit, float dpi, float tesselationTolerance)
 {
+    // rapidxml writes into the text it parses
+    std::vector<char> copy(buffer.c_str(), buffer.c_str() + buffer.size() + 1);
+    return fromSVGBuffer(copy.data(), unit, dpi, tesselationTolerance);
+}
+
+std::vector<Path2D> Path2D::fromSVGBuffer(char *buffer, Unit unit, float dpi, float tesselationTolerance)
+{
+    VG_PROFILE_PHASE(parse);
+    SVGWarningScope warningScope;
 
     std::vector<Path2D> paths;
 
-    std::vector<SVGState> stateStack;
-    stateStack.push_back(SVGState()); // default
-
     xml_document<> doc;    // character type defaults to char
-    doc.parse<0>((char*)buffer.c_str());    // 0 means default parse flags
+    doc.parse<0>(buffer);    // 0 means default parse flags
 
     xml_node<> *svg = doc.first_node("svg");
-    processSvgChildrenNodes(svg, stateStack, paths, tesselationTolerance);
+    processSvgChildrenNodes(svg, SVGStyle(), paths, tesselationTolerance);
 
     return paths;
 }
 
+bool Path2D::streamSVGFile(const std::string &filePath, Unit unit, float dpi, float tesselationTolerance, const std::function<void(Path2D &path)> &sink)
+{
+    VG_PROFILE_PHASE(parse);
+
+    XmlStreamReader reader;
+    if (!reader.open(filePath))
+    {
+        VG_LOG_CRITICAL("Could not open %s", filePath.c_str());
+        return false;
+    }
 
+    SVGWarningScope warningScope;
 
+    // one style per open <g>, on top of the default one
+    std::vector<SVGStyle> styleStack;
+    styleStack.reserve(32);
+    styleStack.push_back(SVGStyle()); // default
 
-Path2D::Path2D(float tesselationFactor, const std::string &svgData) : tesselationTolerance(1.0f / tesselationFactor) {
+    size_t depth = 0; // open elements
+    size_t svgDepth = 0; // depth of the <svg> element, 0 until it is found
+    size_t skippedDepth = 0; // depth of the element whose content is skipped, 0 if none
 
-    struct Command {
-        char id;
-        std::vector<float> params;
+    for (;;) {
+        switch (reader.next()) {
+            case XmlStreamReader::Token::startElement: {
+                ++depth;
+                if (skippedDepth) {
+                    break;
+                }
 
-        void addParam(std::string paramStr) {
-            trim(paramStr);
-            if (paramStr.size() > 0) {
-                params.push_back(atof(paramStr.c_str()));
+                const char *name = reader.name();
+                SVGElement element = svgElement(name);
+                if (!svgDepth) {
+                    // like fromSVGBuffer(), only the first <svg> element is read
+                    if (depth == 1 && element == SVGElement::svg) {
+                        svgDepth = depth;
+                    } else {
+                        skippedDepth = depth;
+                    }
+                } else if (element == SVGElement::g) {
+                    styleStack.push_back(styleStack.back());
+                    SVGGeometry geometry;
+                    applySvgAttributes(name, reader.attributes(), styleStack.back(), geometry);
+                } else if (element == SVGElement::path || element == SVGElement::circle) {
+                    SVGStyle style = styleStack.back();
+                    SVGGeometry geometry;
+                    applySvgAttributes(name, reader.attributes(), style, geometry);
+
+                    bool isPath = element == SVGElement::path;
+                    Path2D path = isPath ? Path2D(tesselationTolerance, geometry.d) : Path2D(tesselationTolerance);
+                    if (!isPath) {
+                        path.arc(geometry.cx, geometry.cy, geometry.r, 0.0f, glm::two_pi<float>(), true);
+                    }
+                    applySvgStyle(path, style);
+                    sink(path);
+
+                    // children of shapes aren't drawn
+                    skippedDepth = depth;
+                } else {
+                    SVG_WARNING("Unsupported SVG node <%s>", name);
+                    skippedDepth = depth;
+                }
+                break;
             }
-        }
-    };
 
-    std::vector<Command> commands;
+            case XmlStreamReader::Token::endElement:
+                if (depth == 0) {
+                    VG_LOG_CRITICAL("Could not parse %s: unexpected </%s>", filePath.c_str(), reader.name());
+                    return false;
+                }
+                if (skippedDepth) {
+                    if (depth == skippedDepth) {
+                        skippedDepth = 0;
+                    }
+                } else if (depth == svgDepth) {
+                    return true;
+                } else {
+                    styleStack.pop_back();
+                }
+                --depth;
+                break;
 
-    size_t paramStart = 0;
-    for (size_t i = 0; i < svgData.size(); ++i) {
-        if (isalpha(svgData[i]) || svgData[i] == ',' || svgData[i] == ' ' || svgData[i] == '-') {
-            commands.back().addParam(svgData.substr(paramStart, i - paramStart));
-            // Ok. I hate SVG for real now.
-            if (svgData[i] == '-') {
-                paramStart = i;
-            } else {
-                paramStart = i+1;
-            }
-        }
+            case XmlStreamReader::Token::end:
+                return true;
 
-        if (isalpha(svgData[i])) {
-            commands.resize(commands.size() + 1);
-            commands.back().id = svgData[i];
+            case XmlStreamReader::Token::error:
+                VG_LOG_CRITICAL("Could not parse %s: %s", filePath.c_str(), reader.error());
+                return false;
         }
     }
-    if (paramStart < svgData.size()) {
-        commands.back().addParam(svgData.substr(paramStart, svgData.size() - paramStart));
-    }
+}
+
+
+
+
+namespace detail
+{
+    // Single pass over SVG path data. Numbers are parsed in place, and
+    // commands can be implicitly repeated by following their parameters with
+    // more parameters.
+    struct PathDataTokenizer
+    {
+        const char *cur;
+        const char *end;
 
-#if 0
-    for (size_t i = 0; i < commands.size(); ++i) {
-        Command &command = commands[i];
-        printf("%c(", command.id);
-        for(size_t j = 0; j < command.params.size(); ++ j) {
-            printf("%3.2ff", command.params[j]);
-            if (j+1 < command.params.size()) printf(", ");
+        inline bool isSeparator(char c) const {
+            return c == ' ' || c == ',' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
         }
-        printf(")\n");
-    }
-#endif
 
-    // reused for relative position from lower-cased commands
-    glm::vec2 prevPoint = glm::vec2(0, 0); 
+        // skips the whitespaces and commas, returns false at the end of the data.
+        inline bool skipSeparators() {
+            while (cur < end && isSeparator(*cur)) ++cur;
+            return cur < end;
+        }
 
-    // reused for smooth bezier
-    glm::vec2 prevControlPoint = glm::vec2(0, 0);
+        inline bool isCommand() const {
+            return (*cur >= 'a' && *cur <= 'z') || (*cur >= 'A' && *cur <= 'Z');
+        }
 
-    for (size_t i = 0; i < commands.size(); ++i) {
-        const Command &command = commands[i];
-
-        switch(command.id) {
-            case 'M': {
-                float x = command.params[0];
-                float y = command.params[1];
-                moveTo(x, y);
-                prevPoint.x = x;
-                prevPoint.y = y;
-                prevControlPoint = prevPoint;
-                break;
+        inline bool number(float &value) {
+            skipSeparators();
+            return parseNumber(cur, end, value);
+        }
+
+        // arc flags are a single '0' or '1', which don't need to be separated
+        // from what follows them.
+        inline bool flag(float &value) {
+            skipSeparators();
+            if (cur < end && (*cur == '0' || *cur == '1')) {
+                value = *cur++ == '1' ? 1.0f : 0.0f;
+                return true;
             }
-            case 'm': {
-                float x = prevPoint.x + command.params[0];
-                float y = prevPoint.y + command.params[1];
-                moveTo(x, y);
-                prevPoint.x = x;
-                prevPoint.y = y;
-                prevControlPoint = prevPoint;
-                break;
+            return false;
+        }
+
+        inline bool numbers(float *values, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                if (!number(values[i])) return false;
             }
-            case 'L': {
-                float x = command.params[0];
-                float y = command.params[1];
-                lineTo(x, y);
-                prevPoint.x = x;
-                prevPoint.y = y;
-                prevControlPoint = prevPoint;
+            return true;
+        }
+    };
+}
+
+Path2D::Path2D(float tesselationFactor, std::string_view svgData) : tesselationTolerance(1.0f / tesselationFactor) {
+
+    VG_PROFILE_PHASE(parse);
+
+    detail::PathDataTokenizer tokenizer = {svgData.data(), svgData.data() + svgData.size()};
+
+    // rough guess from the tiger: a parameter every 5 characters, a command
+    // every 6 parameters. Saves most of the regrowing.
+    commandParams.reserve(svgData.size() / 5);
+    commands.reserve(svgData.size() / 30);
+
+    // reused for relative position from lower-cased commands
+    glm::vec2 prevPoint = glm::vec2(0, 0); 
+
+    // where closePath() goes back to
+    glm::vec2 subPathStart = glm::vec2(0, 0);
+
+    // reused for smooth curves. They only reflect the control point of a
+    // previous curve of the same kind.
+    glm::vec2 prevControlPoint = glm::vec2(0, 0);
+    char prevCommand = 0;
+
+    char command = 0;
+    float params[7];
+
+    while (tokenizer.skipSeparators()) {
+        if (tokenizer.isCommand()) {
+            command = *tokenizer.cur++;
+        } else if (command == 0 || command == 'z' || command == 'Z') {
+            VG_LOG_CRITICAL("Unexpected '%c' in SVG path data", *tokenizer.cur);
+            break;
+        }
+
+        // parameters of the commands, the same as their canvas counterparts
+        bool valid = true;
+        switch(command) {
+            case 'M':
+            case 'm': {
+                valid = tokenizer.numbers(params, 2);
+                if (!valid) break;
+                glm::vec2 point(params[0], params[1]);
+                if (command == 'm') point += prevPoint;
+                moveTo(point.x, point.y);
+                prevPoint = subPathStart = point;
+
+                // extra coordinates pairs are implicit lineTo
+                command = command == 'M' ? 'L' : 'l';
                 break;
             }
+            case 'L':
             case 'l': {
-                float x = prevPoint.x + command.params[0];
-                float y = prevPoint.y + command.params[1];
-                lineTo(x, y);
-                prevPoint.x = x;
-                prevPoint.y = y;
-                prevControlPoint = prevPoint;
-                break;
-            }
-            case 'H':{
-                float x = command.params[0];
-                float y = prevPoint.y;
-                lineTo(x, y);
-                prevPoint.x = x;
-                prevControlPoint.x = prevPoint.x;
-                break;
-            }
-            case 'h':{
-                float x = prevPoint.x + command.params[0];
-                float y = prevPoint.y;
-                lineTo(x, y);
-                prevPoint.x = x;
-                prevControlPoint.x = prevPoint.x;
+                valid = tokenizer.numbers(params, 2);
+                if (!valid) break;
+                glm::vec2 point(params[0], params[1]);
+                if (command == 'l') point += prevPoint;
+                lineTo(point.x, point.y);
+                prevPoint = point;
                 break;
             }
-            case 'V':{
-                float x = prevPoint.x; 
-                float y = command.params[0];
-                lineTo(x, y);
-                prevPoint.y = y;
-                prevControlPoint.y = prevPoint.y;
+            case 'H':
+            case 'h': {
+                valid = tokenizer.number(params[0]);
+                if (!valid) break;
+                prevPoint.x = command == 'h' ? prevPoint.x + params[0] : params[0];
+                lineTo(prevPoint.x, prevPoint.y);
                 break;
             }
+            case 'V':
             case 'v': {
-                float x = prevPoint.x; 
-                float y = prevPoint.y + command.params[0];
-                lineTo(x, y);
-                prevPoint.y = y;
-                prevControlPoint.y = prevPoint.y;
-                break;
-            }
-            case 'C': {
-                float cp1x = command.params[0];
-                float cp1y = command.params[1];
-                float cp2x = command.params[2];
-                float cp2y = command.params[3];
-                float x = command.params[4];
-                float y = command.params[5];
-                bezierCurveTo(cp1x, cp1y, cp2x, cp2y, x, y);
-                prevPoint.x = x;
-                prevPoint.y = y;
-                prevControlPoint.x = cp2x;
-                prevControlPoint.x = cp2y;
+                valid = tokenizer.number(params[0]);
+                if (!valid) break;
+                prevPoint.y = command == 'v' ? prevPoint.y + params[0] : params[0];
+                lineTo(prevPoint.x, prevPoint.y);
                 break;
             }
+            case 'C':
             case 'c': {
-                float cp1x = prevPoint.x + command.params[0];
-                float cp1y = prevPoint.y + command.params[1];
-                float cp2x = prevPoint.x + command.params[2];
-                float cp2y = prevPoint.y + command.params[3];
-                float x = prevPoint.x + command.params[4];
-                float y = prevPoint.y + command.params[5];
-                bezierCurveTo(cp1x, cp1y, cp2x, cp2y, x, y);
-                prevPoint.x = x;
-                prevPoint.y = y;
-                prevControlPoint.x = cp2x;
-                prevControlPoint.x = cp2y;
+                valid = tokenizer.numbers(params, 6);
+                if (!valid) break;
+                glm::vec2 offset = command == 'c' ? prevPoint : glm::vec2(0, 0);
+                glm::vec2 cp1 = glm::vec2(params[0], params[1]) + offset;
+                glm::vec2 cp2 = glm::vec2(params[2], params[3]) + offset;
+                glm::vec2 point = glm::vec2(params[4], params[5]) + offset;
+                bezierCurveTo(cp1.x, cp1.y, cp2.x, cp2.y, point.x, point.y);
+                prevControlPoint = cp2;
+                prevPoint = point;
                 break;
             }
-            case 'S': {
-                float cp1x = 2.0 * prevPoint.x - prevControlPoint.x;
-                float cp1y = 2.0 * prevPoint.y - prevControlPoint.y;
-                float cp2x = command.params[0];
-                float cp2y = command.params[1];
-                float x = command.params[2];
-                float y = command.params[3];
-                bezierCurveTo(cp1x, cp1y, cp2x, cp2y, x, y);
-                prevPoint.x = x;
-                prevPoint.y = y;
-                prevControlPoint.x = cp2x;
-                prevControlPoint.x = cp2y;
+            case 'S':
+            case 's': {
+                valid = tokenizer.numbers(params, 4);
+                if (!valid) break;
+                // the first control point is the reflection of the previous
+                // cubic one, or the current point after any other command.
+                bool smooth = prevCommand == 'C' || prevCommand == 'c' || prevCommand == 'S' || prevCommand == 's';
+                glm::vec2 cp1 = smooth ? 2.0f * prevPoint - prevControlPoint : prevPoint;
+                glm::vec2 offset = command == 's' ? prevPoint : glm::vec2(0, 0);
+                glm::vec2 cp2 = glm::vec2(params[0], params[1]) + offset;
+                glm::vec2 point = glm::vec2(params[2], params[3]) + offset;
+                bezierCurveTo(cp1.x, cp1.y, cp2.x, cp2.y, point.x, point.y);
+                prevControlPoint = cp2;
+                prevPoint = point;
                 break;
             }
-            case 's': {
-                float cp1x = 2.0 * prevPoint.x - prevControlPoint.x;
-                float cp1y = 2.0 * prevPoint.y - prevControlPoint.y;
-                float cp2x = prevPoint.x + command.params[0];
-                float cp2y = prevPoint.x + command.params[1];
-                float x = prevPoint.x + command.params[2];
-                float y = prevPoint.x + command.params[3];
-                bezierCurveTo(cp1x, cp1y, cp2x, cp2y, x, y);
-                prevPoint.x = x;
-                prevPoint.y = y;
-                prevControlPoint.x = cp2x;
-                prevControlPoint.x = cp2y;
+            case 'Q':
+            case 'q': {
+                valid = tokenizer.numbers(params, 4);
+                if (!valid) break;
+                glm::vec2 offset = command == 'q' ? prevPoint : glm::vec2(0, 0);
+                glm::vec2 cp = glm::vec2(params[0], params[1]) + offset;
+                glm::vec2 point = glm::vec2(params[2], params[3]) + offset;
+                quadraticCurveTo(cp.x, cp.y, point.x, point.y);
+                prevControlPoint = cp;
+                prevPoint = point;
                 break;
             }
-            case 'Q': {
-                float cpx = command.params[0];
-                float cpy = command.params[1];
-                float x = command.params[2];
-                float y = command.params[3];
-                quadraticCurveTo(cpx, cpy, x, y);
-                prevControlPoint.x = cpx;
-                prevControlPoint.y = cpy;
-                prevPoint.x = x;
-                prevPoint.y = y;
+            case 'T':
+            case 't': {
+                valid = tokenizer.numbers(params, 2);
+                if (!valid) break;
+                // the control point is the reflection of the previous
+                // quadratic one, or the current point after any other command.
+                bool smooth = prevCommand == 'Q' || prevCommand == 'q' || prevCommand == 'T' || prevCommand == 't';
+                glm::vec2 cp = smooth ? 2.0f * prevPoint - prevControlPoint : prevPoint;
+                glm::vec2 point = glm::vec2(params[0], params[1]) + (command == 't' ? prevPoint : glm::vec2(0, 0));
+                quadraticCurveTo(cp.x, cp.y, point.x, point.y);
+                prevControlPoint = cp;
+                prevPoint = point;
                 break;
             }
-            case 'q': {
-                float cpx = prevPoint.x + command.params[0];
-                float cpy = prevPoint.y + command.params[1];
-                float x = prevPoint.x + command.params[2];
-                float y = prevPoint.y + command.params[3];
-                quadraticCurveTo(cpx, cpy, x, y);
-                prevControlPoint.x = cpx;
-                prevControlPoint.y = cpy;
-                prevPoint.x = x;
-                prevPoint.y = y;
+            case 'A':
+            case 'a': {
+                // rx ry x-axis-rotation large-arc-flag sweep-flag x y
+                valid = tokenizer.numbers(params, 3) && tokenizer.flag(params[3]) && tokenizer.flag(params[4]) &&
+                        tokenizer.numbers(params + 5, 2);
+                if (!valid) break;
+                glm::vec2 point(params[5], params[6]);
+                if (command == 'a') point += prevPoint;
+
+                detail::EllipseArc arc;
+                if (detail::arcEndpointToCenter(prevPoint, point, params[0], params[1], glm::radians(params[2]),
+                                                params[3] != 0.0f, params[4] != 0.0f, arc)) {
+                    ellipse(arc.center.x, arc.center.y, arc.radius.x, arc.radius.y, arc.rotation,
+                            arc.startAngle, arc.endAngle, arc.anticlockwise);
+                } else {
+                    lineTo(point.x, point.y);
+                }
+                prevPoint = point;
                 break;
             }
+            case 'Z':
             case 'z':
                 closePath();
+                prevPoint = subPathStart;
                 break;
             default:
-                SDL_LogCritical(0, "Command '%c' not supported!!!\n", command.id);
-                break;
+                VG_LOG_CRITICAL("Command '%c' not supported!!!\n", command);
+                return;
         }
-    }
 
+        // like browsers, render what was parsed up to the error.
+        if (!valid) {
+            VG_LOG_CRITICAL("Invalid parameters for SVG path command '%c'", command);
+            break;
+        }
 
+        prevCommand = command;
+    }
 }
 
 void Path2D::beginPath() {
+    commands.clear();
+    commandParams.clear();
     subPaths.clear();
+    pendingCurves.clear();
+    flattenedTolerance = 0.0f;
 }
 
 void Path2D::closePath() {
-    if (subPaths.size() > 0) {
-        auto &subPath = subPaths.back();
-        // we need at least 3 points to form a closed shape. Otherwise it is a line or a dot and we can't close that.
-        if (subPath.points.size() >= 3) {
-            subPath.closed = true;
-        }
-    }
+    record(PathCommand::closePath, {});
 }
 
 void Path2D::moveTo(float x, float y) {
-    SubPath2D &subPath = createSubPath();
-    detail::addPoint(subPath.points, glm::vec2(x, y), PointProperties::corner);
+    record(PathCommand::moveTo, {x, y});
 }
 
 void Path2D::lineTo(float x, float y) {
-    SubPath2D &subPath = getCurrentSubPath();
-    detail::addPoint(subPath.points, glm::vec2(x, y), PointProperties::corner);
+    record(PathCommand::lineTo, {x, y});
 }
 
 void Path2D::bezierCurveTo(float cp1x, float cp1y, float cp2x, float cp2y, float x, float y) {
-    SubPath2D &subPath = getCurrentSubPath();
-    auto &points = subPath.points;
-    auto &prevPoint = points.back().pos;
-    detail::bezierTo(points, prevPoint.x, prevPoint.y, cp1x, cp1y, cp2x, cp2y, x, y, tesselationTolerance);
+    record(PathCommand::bezierCurveTo, {cp1x, cp1y, cp2x, cp2y, x, y});
 }
 
 void Path2D::quadraticCurveTo(float cpx, float cpy, float x, float y) {
-    SubPath2D &subPath = getCurrentSubPath();
-    auto &points = subPath.points;
-    auto &prevPoint = points.back().pos;
-    float c1x = prevPoint.x + 2.0f/3.0f*(cpx - prevPoint.x);
-    float c1y = prevPoint.y + 2.0f/3.0f*(cpy - prevPoint.y);
-    float c2x = x + 2.0f/3.0f*(cpx - x);
-    float c2y = y + 2.0f/3.0f*(cpy - y);
-    detail::bezierTo(points, prevPoint.x, prevPoint.y, c1x, c1y, c2x, c2y, x, y, tesselationTolerance);
+    record(PathCommand::quadraticCurveTo, {cpx, cpy, x, y});
 }
 
 void Path2D::arc(float x, float y, float radius, float startAngle, float endAngle, bool anticlockwise) {
-    SubPath2D &subPath = getCurrentSubPath(false);
-    detail::arc(subPath.points, glm::vec2(x, y), radius, startAngle, endAngle, anticlockwise, tesselationTolerance);
+    record(PathCommand::arc, {x, y, radius, startAngle, endAngle, anticlockwise ? 1.0f : 0.0f});
 }
 
 void Path2D::arcTo(float x1, float y1, float x2, float y2, float radius) {
-    SubPath2D &subPath = getCurrentSubPath();
-    auto &points = subPath.points;
-    auto &prevPoint = points.back().pos;
-    detail::arcTo(points, prevPoint, glm::vec2(x1, y1), glm::vec2(x2, y2), radius, tesselationTolerance);
+    record(PathCommand::arcTo, {x1, y1, x2, y2, radius});
 }
 
 void Path2D::ellipse(float x, float y, float radiusX, float radiusY, float rotation, float startAngle, float endAngle, bool anticlockwise) {
-    // TODO
-    assert(false);
+    record(PathCommand::ellipse, {x, y, radiusX, radiusY, rotation, startAngle, endAngle, anticlockwise ? 1.0f : 0.0f});
 }
 
 void Path2D::rect(float x, float y, float width, float height) {
-    closePath();
-    SubPath2D &subPath = createSubPath();
-    auto &points = subPath.points;
-    detail::addPoint(points, glm::vec2(x, y), PointProperties::corner);
-    detail::addPoint(points, glm::vec2(x, y+height), PointProperties::corner);
-    detail::addPoint(points, glm::vec2(x+width, y+height), PointProperties::corner);
-    detail::addPoint(points, glm::vec2(x+width, y), PointProperties::corner);
-    subPath.closed = true;
+    record(PathCommand::rect, {x, y, width, height});
 }
 
-void Path2D::fill(Mesh &mesh) {
+void Path2D::setTesselationFactor(float tesselationFactor) {
+    // the subpaths get flattened again on the next fill() or stroke().
+    tesselationTolerance = 1.0f / tesselationFactor;
+}
 
-    // close circular paths.
-    for (size_t id = 0; id < subPaths.size(); ++id) {
-        auto &subPath = subPaths[id];
-        auto &points = subPath.points;
+void Path2D::setTransform(const Transform2D &transform) {
+    if (this->transform != transform) {
+        this->transform = transform;
+        flattenedTolerance = 0.0f;
+    }
+}
 
-        // Check if the first and last point are the same. Get rid of
-        // the last point if that is the case, and close the subpath.
-        if (points.size() >= 2 && glm::all(glm::epsilonEqual(points[0].pos, points.back().pos, distTol)))
-        {
-            points.resize(points.size()-1);
-            subPath.closed = true;
+BoundingBox Path2D::getBounds() const {
+    BoundingBox bounds;
+    const float *params = commandParams.data();
+    for (PathCommand command : commands) {
+        switch (command) {
+            case PathCommand::moveTo:
+            case PathCommand::lineTo:
+                bounds.add(glm::vec2(params[0], params[1]));
+                params += 2;
+                break;
+            case PathCommand::bezierCurveTo:
+                bounds.add(glm::vec2(params[0], params[1]));
+                bounds.add(glm::vec2(params[2], params[3]));
+                bounds.add(glm::vec2(params[4], params[5]));
+                params += 6;
+                break;
+            case PathCommand::quadraticCurveTo:
+                bounds.add(glm::vec2(params[0], params[1]));
+                bounds.add(glm::vec2(params[2], params[3]));
+                params += 4;
+                break;
+            case PathCommand::arc: {
+                glm::vec2 center(params[0], params[1]);
+                float radius = glm::abs(params[2]);
+                bounds.add(center - radius);
+                bounds.add(center + radius);
+                params += 6;
+                break;
+            }
+            case PathCommand::arcTo:
+                bounds.add(glm::vec2(params[0], params[1]));
+                bounds.add(glm::vec2(params[2], params[3]));
+                params += 5;
+                break;
+            case PathCommand::ellipse: {
+                glm::vec2 center(params[0], params[1]);
+                float radius = glm::max(glm::abs(params[2]), glm::abs(params[3]));
+                bounds.add(center - radius);
+                bounds.add(center + radius);
+                params += 8;
+                break;
+            }
+            case PathCommand::rect:
+                bounds.add(glm::vec2(params[0], params[1]));
+                bounds.add(glm::vec2(params[0] + params[2], params[1] + params[3]));
+                params += 4;
+                break;
+            case PathCommand::closePath:
+                break;
         }
     }
 
-    for (size_t id = 0; id < subPaths.size(); ++id) {
-        auto &points = subPaths[id].points;
-
-        // we need at least 3 points to make a shape. Otherwise it is a line or a point or nothing at all :-) 
-        if (points.size() >= 3) {
-
-            MPEPolyContext polyContext;
-            
-            // Request how much memory (in bytes) you should
-            // allocate for the library
-            size_t memoryRequired = MPE_PolyMemoryRequired(points.size());
-
-            // Allocate a memory block of size MemoryRequired
-            // IMPORTANT: The memory must be zero initialized
-            std::vector<uint8_t> mempool;
-            mempool.resize(memoryRequired, 0);
+    if (!bounds.empty() && transform != Transform2D()) {
+        BoundingBox transformedBounds;
+        transformedBounds.add(transform.apply(bounds.min));
+        transformedBounds.add(transform.apply(glm::vec2(bounds.max.x, bounds.min.y)));
+        transformedBounds.add(transform.apply(bounds.max));
+        transformedBounds.add(transform.apply(glm::vec2(bounds.min.x, bounds.max.y)));
+        bounds = transformedBounds;
+    }
 
-            // Initialize the poly context by passing the memory pointer,
-            // and max number of points from before
-            MPE_PolyInitContext(&polyContext, mempool.data(), points.size());
+    // strokes reach half of the line width past the path.
+    if (!bounds.empty() && strokeStyle.a > 0) {
+        float halfLineWidth = lineWidth * transform.averageScale() * 0.5f;
+        bounds.min -= halfLineWidth;
+        bounds.max += halfLineWidth;
+    }
 
-            MPEPolyPoint* polyPoints = MPE_PolyPushPointArray(&polyContext, points.size());
-            for(size_t j = 0; j < points.size(); ++j)
-            {
-                glm::vec2 &point = points[j].pos;
+    return bounds;
+}
 
-                polyPoints[j].X = point.x;
-                polyPoints[j].Y = point.y;
-            }
+// FNV-1a, 64 bits.
+static inline uint64_t hashBytes(uint64_t hash, const void *data, size_t size) {
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
 
-            MPE_PolyAddEdge(&polyContext);
+uint64_t Path2D::contentHash() const {
+    uint64_t hash = 14695981039346656037ull;
+    uint64_t commandCount = commands.size();
+    hash = hashBytes(hash, &commandCount, sizeof(commandCount));
+    hash = hashBytes(hash, commands.data(), commands.size() * sizeof(PathCommand));
+    hash = hashBytes(hash, commandParams.data(), commandParams.size() * sizeof(float));
+
+    const float style[] = {lineWidth, miterLimit, transform.a, transform.b, transform.c, transform.d, transform.e, transform.f};
+    const uint8_t styleEnums[] = {static_cast<uint8_t>(lineJoin), static_cast<uint8_t>(lineCap), static_cast<uint8_t>(fillRule), static_cast<uint8_t>(curveFlattener)};
+    hash = hashBytes(hash, &fillStyle[0], 4);
+    hash = hashBytes(hash, &strokeStyle[0], 4);
+    hash = hashBytes(hash, style, sizeof(style));
+    hash = hashBytes(hash, styleEnums, sizeof(styleEnums));
+    return hash;
+}
 
-            MPE_PolyTriangulate(&polyContext);
+void Path2D::record(PathCommand command, std::initializer_list<float> params) {
+    commands.push_back(command);
+    commandParams.insert(commandParams.end(), params);
+    flattenedTolerance = 0.0f;
+}
 
-            uint32_t vertexCount = polyContext.PointPoolCount;
-            uint16_t indexCount = polyContext.TriangleCount*3;
+void Path2D::flatten() {
+    if (flattenedTolerance == tesselationTolerance && flattenedCurveFlattener == curveFlattener) {
+        return;
+    }
 
-            uint16_t offset = mesh.vertices.size();
+    VG_PROFILE_PHASE(flatten);
 
-            // populate the vertices
-            for (size_t vid = 0; vid < polyContext.PointPoolCount; ++vid) {
-                MPEPolyPoint &point = polyContext.PointsPool[vid];
-                mesh.vertices.push_back({{point.X, point.Y, 0.0f}, fillStyle});
+    subPaths.clear();
+    pendingCurves.clear();
+
+    // the commands are transformed as they are flattened. Only arcTo() needs
+    // the current point back in the coordinates of the commands.
+    Transform2D inverseTransform;
+    bool invertible = transform.inverse(inverseTransform);
+
+    const float *params = commandParams.data();
+    for (PathCommand command : commands) {
+        switch (command) {
+            case PathCommand::moveTo: {
+                SubPath2D &subPath = createSubPath();
+                detail::addPoint(subPath.points, transform.apply(glm::vec2(params[0], params[1])), PointProperties::corner);
+                params += 2;
+                break;
             }
-
-            // populate the indices
-            for (size_t tid = 0; tid < polyContext.TriangleCount; ++tid) {
-                MPEPolyTriangle* triangle = polyContext.Triangles[tid];
-
-                // get the array index by pointer address arithmetic.
-                uint16_t p0 = static_cast<uint16_t>(triangle->Points[0] - polyContext.PointsPool);
-                uint16_t p1 = static_cast<uint16_t>(triangle->Points[1] - polyContext.PointsPool);
-                uint16_t p2 = static_cast<uint16_t>(triangle->Points[2] - polyContext.PointsPool);
-                mesh.indices.push_back(offset+p2);
-                mesh.indices.push_back(offset+p1);
-                mesh.indices.push_back(offset+p0);
+            case PathCommand::lineTo: {
+                SubPath2D &subPath = getCurrentSubPath();
+                detail::addPoint(subPath.points, transform.apply(glm::vec2(params[0], params[1])), PointProperties::corner);
+                params += 2;
+                break;
+            }
+            case PathCommand::bezierCurveTo: {
+                SubPath2D &subPath = getCurrentSubPath();
+                glm::vec2 cp1 = transform.apply(glm::vec2(params[0], params[1]));
+                glm::vec2 cp2 = transform.apply(glm::vec2(params[2], params[3]));
+                glm::vec2 end = transform.apply(glm::vec2(params[4], params[5]));
+                if (curveFlattener == CurveFlattener::batched) {
+                    batchBezierTo(subPath, cp1.x, cp1.y, cp2.x, cp2.y, end.x, end.y);
+                } else {
+                    auto &points = subPath.points;
+                    auto &prevPoint = points.back().pos;
+                    detail::bezierTo(points, prevPoint.x, prevPoint.y, cp1.x, cp1.y, cp2.x, cp2.y, end.x, end.y, tesselationTolerance, curveFlattener);
+                }
+                params += 6;
+                break;
+            }
+            case PathCommand::quadraticCurveTo: {
+                SubPath2D &subPath = getCurrentSubPath();
+                auto &points = subPath.points;
+                auto &prevPoint = points.back().pos;
+                glm::vec2 cp = transform.apply(glm::vec2(params[0], params[1]));
+                glm::vec2 end = transform.apply(glm::vec2(params[2], params[3]));
+                float cpx = cp.x;
+                float cpy = cp.y;
+                float x = end.x;
+                float y = end.y;
+                if (curveFlattener == CurveFlattener::batched) {
+                    // Degree elevation keeps the parametrization, and Wang's formula on the
+                    // elevated cubic gives the same segment count as the quadratic bound,
+                    // so the batch can treat it like any other cubic.
+                    float c1x = prevPoint.x + 2.0f/3.0f*(cpx - prevPoint.x);
+                    float c1y = prevPoint.y + 2.0f/3.0f*(cpy - prevPoint.y);
+                    float c2x = x + 2.0f/3.0f*(cpx - x);
+                    float c2y = y + 2.0f/3.0f*(cpy - y);
+                    batchBezierTo(subPath, c1x, c1y, c2x, c2y, x, y);
+                } else {
+                    detail::quadraticBezierTo(points, prevPoint.x, prevPoint.y, cpx, cpy, x, y, tesselationTolerance);
+                }
+                params += 4;
+                break;
+            }
+            case PathCommand::arc: {
+                SubPath2D &subPath = getCurrentSubPath(false);
+                detail::arc(subPath.points, glm::vec2(params[0], params[1]), params[2], params[3], params[4], params[5] != 0.0f, tesselationTolerance, transform);
+                params += 6;
+                break;
+            }
+            case PathCommand::arcTo: {
+                SubPath2D &subPath = getCurrentSubPath();
+                auto &points = subPath.points;
+                glm::vec2 prevPoint = points.back().pos;
+                if (invertible) {
+                    detail::arcTo(points, inverseTransform.apply(prevPoint), glm::vec2(params[0], params[1]), glm::vec2(params[2], params[3]), params[4], tesselationTolerance, transform);
+                } else {
+                    // everything lands on a line or a point, so does the corner.
+                    detail::addPoint(points, transform.apply(glm::vec2(params[0], params[1])), PointProperties::corner);
+                }
+                params += 5;
+                break;
+            }
+            case PathCommand::ellipse: {
+                SubPath2D &subPath = getCurrentSubPath(false);
+                detail::ellipse(subPath.points, glm::vec2(params[0], params[1]), params[2], params[3], params[4], params[5], params[6], params[7] != 0.0f, tesselationTolerance, transform);
+                params += 8;
+                break;
+            }
+            case PathCommand::rect: {
+                closeSubPath();
+                float x = params[0];
+                float y = params[1];
+                float width = params[2];
+                float height = params[3];
+                SubPath2D &subPath = createSubPath();
+                auto &points = subPath.points;
+                detail::addPoint(points, transform.apply(glm::vec2(x, y)), PointProperties::corner);
+                detail::addPoint(points, transform.apply(glm::vec2(x, y+height)), PointProperties::corner);
+                detail::addPoint(points, transform.apply(glm::vec2(x+width, y+height)), PointProperties::corner);
+                detail::addPoint(points, transform.apply(glm::vec2(x+width, y)), PointProperties::corner);
+                subPath.closed = true;
+                params += 4;
+                break;
             }
+            case PathCommand::closePath:
+                closeSubPath();
+                break;
         }
     }
-    subPaths.clear();
-}
 
-void Path2D::fillRect(Mesh &mesh, float x, float y, float width, float height) {
-    rect(x, y, width, height);
-    fill(mesh);
-    subPaths.clear();
-}
-
-void Path2D::stroke(Mesh &mesh) {
+    flattenCurveBatch();
 
-    float halfLineWidth = lineWidth * 0.5f;
-
-    // close circular paths.
+    // close circular paths, and find the convex ones fill() can draw as a fan.
     for (size_t id = 0; id < subPaths.size(); ++id) {
         auto &subPath = subPaths[id];
         auto &points = subPath.points;
@@ -911,512 +1718,419 @@ void Path2D::stroke(Mesh &mesh) {
             points.resize(points.size()-1);
             subPath.closed = true;
         }
-    }
 
-    // Calculate direction vectors for each points of each subpaths
-    for(size_t id = 0; id < subPaths.size(); ++id) {
-        SubPath2D &subPath = subPaths[id];
+        subPath.convex = detail::isConvex(points);
+    }
 
-        size_t p0, p1;
+    flattenedTolerance = tesselationTolerance;
+    flattenedCurveFlattener = curveFlattener;
+}
 
-        if (subPath.closed)
-        {
-            p0 = subPath.points.size() - 1;
-            p1 = 0;
-        }
-        else
-        {
-            p0 = 0;
-            p1 = 1;
+void Path2D::closeSubPath() {
+    if (subPaths.size() > 0) {
+        auto &subPath = subPaths.back();
+        // we need at least 3 points to form a closed shape. Otherwise it is a line or a dot and we can't close that.
+        // Batched curves only have their end point in there until they get flattened.
+        bool hasBatchedCurve = !pendingCurves.empty() && pendingCurves.back().subPathIndex == subPaths.size() - 1;
+        if (subPath.points.size() >= 3 || hasBatchedCurve) {
+            subPath.closed = true;
         }
+    }
+}
 
-        while(p1 < subPath.points.size())
-        {
-            glm::vec2 delta = subPath.points[p1].pos - subPath.points[p0].pos;
-            float length = glm::length(delta);
-            subPath.points[p0].length = length;
-            subPath.points[p0].dir = delta / length;
-            p0 = p1++;
+void Path2D::batchBezierTo(SubPath2D &subPath, float cp1x, float cp1y, float cp2x, float cp2y, float x, float y) {
+    auto &points = subPath.points;
+
+    // only the end point is added for now, the rest of the curve gets
+    // inserted in front of it by flattenCurveBatch(). It is pushed even if it
+    // lands on the previous point so the curve keeps its place in the contour.
+    pendingCurves.push_back({points.back().pos, glm::vec2(cp1x, cp1y), glm::vec2(cp2x, cp2y), glm::vec2(x, y),
+                             static_cast<uint32_t>(&subPath - subPaths.data()), static_cast<uint32_t>(points.size())});
+    detail::pushPoint(points, glm::vec2(x, y), PointProperties::corner);
+}
+
+void Path2D::flattenCurveBatch() {
+    if (pendingCurves.empty()) {
+        return;
+    }
+
+    CurveBatch &curveBatch = CurveBatch::current();
+    curveBatch.flatten(pendingCurves, detail::distanceTolerance(tesselationTolerance), BEZIER_SEGMENT_LIMIT);
+
+    // rebuild the contours that have curves, one subpath at a time. The old
+    // point array becomes the scratch buffer of the next subpath.
+    std::vector<ContourPoint> points;
+    size_t curve = 0;
+    while (curve < pendingCurves.size()) {
+        uint32_t subPathIndex = pendingCurves[curve].subPathIndex;
+        auto &source = subPaths[subPathIndex].points;
+
+        size_t lastCurve = curve;
+        while (lastCurve < pendingCurves.size() && pendingCurves[lastCurve].subPathIndex == subPathIndex) {
+            ++lastCurve;
         }
 
-        if (!subPath.closed)
-        {
-            // last point should have the same direction than its
-            // previous point.
-            subPath.points[p0].dir = subPath.points[p0-1].dir;
+        points.clear();
+        points.reserve(source.size() + curveBatch.firstPoint[lastCurve] - curveBatch.firstPoint[curve]);
+
+        size_t next = 0;
+        for (; curve < lastCurve; ++curve) {
+            uint32_t pointIndex = pendingCurves[curve].pointIndex;
+            points.insert(points.end(), source.begin() + next, source.begin() + pointIndex);
+
+            for (uint32_t j = curveBatch.firstPoint[curve]; j < curveBatch.firstPoint[curve + 1]; ++j) {
+                detail::pushPoint(points, glm::vec2(curveBatch.pointsX[j], curveBatch.pointsY[j]), PointProperties::none);
+            }
+
+            // the end point, with the same duplicate check as the other flatteners.
+            if (!glm::all(glm::epsilonEqual(points.back().pos, source[pointIndex].pos, distTol))) {
+                points.push_back(source[pointIndex]);
+            }
+            next = pointIndex + 1;
         }
+        points.insert(points.end(), source.begin() + next, source.end());
 
+        source.swap(points);
     }
 
-    for(size_t id = 0; id < subPaths.size(); ++id) {
+    pendingCurves.clear();
+}
 
-        SubPath2D &subPath = subPaths[id];
+void Path2D::fill(Mesh &mesh) {
 
-        auto &points = subPath.points;
-        auto &outerPoints = subPath.outerPoints;
-        auto &innerPoints = subPath.innerPoints;
+    flatten();
 
-        if(subPath.closed) {
+    for (size_t id = 0; id < subPaths.size(); ++id) {
+        VG_PROFILE_COUNT(contourPoints, subPaths[id].points.size());
+    }
 
-            // Calculate normal vectors
-            for (size_t p0 = points.size() - 1, p1 = 0; p1 < points.size(); p0 = p1++)
-            {
-                // rotate direction vector by 90degree CW
-                glm::vec2 dir0 = glm::vec2(points[p0].dir.y, -points[p0].dir.x);
-                glm::vec2 dir1 = glm::vec2(points[p1].dir.y, -points[p1].dir.x);
-                glm::vec2 norm = (dir0 + dir1) * 0.5f;
-                float dot = glm::dot(norm, norm);
-                if (dot > glm::epsilon<float>())
-                {
-                    norm *= glm::clamp(1.0f / dot, 0.0f, 1000.0f);
-                }
-                points[p1].norm = norm;
+    fillSubPaths(mesh, false);
+}
 
-                float cross = glm::cross(points[p1].dir, points[p0].dir);
-                points[p1].properties.set(cross > 0.0f ? PointProperties::leftTurn : PointProperties::rightTurn);
+void Path2D::fillRect(Mesh &mesh, float x, float y, float width, float height) {
+    // like the canvas, this doesn't touch the current path. A rectangle is two
+    // triangles, no need to flatten or triangulate anything.
+    if (width == 0.0f || height == 0.0f) {
+        return;
+    }
 
-                float sharpnessLimit = glm::min(points[p0].length, points[p1].length) * (1.0f / halfLineWidth);
-                if (dot * sharpnessLimit * sharpnessLimit > 1.0f)
-                {
-                    points[p1].properties.set(PointProperties::sharp);
-                }
+    VG_PROFILE_COUNT(contourPoints, 4);
+    VG_PROFILE_PHASE(meshAppend);
 
-                if (points[p1].properties.test(PointProperties::corner))
-                {
-                    if (lineJoin == LineJoin::bevel || lineJoin == LineJoin::round ||
-                        dot * miterLimit * miterLimit < 1.0f)
-                    {
-                        points[p1].properties.set(PointProperties::bevel);
-                    }
-                }
-            }
+    const glm::vec2 corners[4] = {
+        transform.apply(glm::vec2(x, y)),
+        transform.apply(glm::vec2(x, y+height)),
+        transform.apply(glm::vec2(x+width, y+height)),
+        transform.apply(glm::vec2(x+width, y)),
+    };
 
+    uint16_t offset = mesh.beginVertices(4);
+    for (const glm::vec2 &corner : corners) {
+        mesh.vertices.push_back({{corner.x, corner.y, 0.0f}, fillStyle});
+    }
 
-            // create inner and outer contour
-            for (size_t p0 = points.size() - 1, p1 = 0; p1 < points.size(); p0 = p1++) {
-                if (points[p1].properties.test(PointProperties::bevel))
-                {
-                    if (lineJoin == LineJoin::round)
-                    {
-                        glm::vec2 ext0 = glm::vec2(points[p0].dir.y, -points[p0].dir.x) * halfLineWidth;
-                        glm::vec2 ext1 = points[p1].norm * halfLineWidth;
-                        glm::vec2 ext2 = glm::vec2(points[p1].dir.y, -points[p1].dir.x) * halfLineWidth;
-
-                        if (points[p1].properties.test(PointProperties::leftTurn))
-                        {
-                            detail::addPoint(innerPoints, points[p1].pos + ext1);
-                            detail::addPoint(outerPoints, points[p1].pos - ext0);
-                            detail::arcTo(outerPoints,
-                                    points[p1].pos - ext0,
-                                    points[p1].pos - ext1,
-                                    points[p1].pos - ext2,
-                                    halfLineWidth,
-                                    tesselationTolerance);
-                        }
-                        else
-                        {
-                            detail::addPoint(innerPoints, points[p1].pos + ext0);
-                            detail::arcTo(innerPoints,
-                                    points[p1].pos + ext0,
-                                    points[p1].pos + ext1,
-                                    points[p1].pos + ext2,
-                                    halfLineWidth,
-                                    tesselationTolerance);
-                            detail::addPoint(outerPoints, points[p1].pos - ext1);
-                        }
-                    }
-                    else
-                    {
-                        if (points[p1].properties.test(PointProperties::leftTurn))
-                        {
-                            detail::addPoint(innerPoints, points[p1].pos + points[p1].norm * halfLineWidth);
-                            detail::addPoint(outerPoints, points[p1].pos - glm::vec2(points[p0].dir.y, -points[p0].dir.x) * halfLineWidth);
-                            detail::addPoint(outerPoints, points[p1].pos - glm::vec2(points[p1].dir.y, -points[p1].dir.x) * halfLineWidth);
-                        }
-                        else
-                        {
-                            detail::addPoint(innerPoints, points[p1].pos + glm::vec2(points[p0].dir.y, -points[p0].dir.x) * halfLineWidth);
-                            detail::addPoint(innerPoints, points[p1].pos + glm::vec2(points[p1].dir.y, -points[p1].dir.x) * halfLineWidth);
-                            detail::addPoint(outerPoints, points[p1].pos - points[p1].norm * halfLineWidth);
-
-                        }
+    const uint16_t rectIndices[] = {0, 1, 2, 0, 2, 3};
+    for (uint16_t index : rectIndices) {
+        mesh.indices.push_back(offset+index);
+    }
+}
 
-                    }
-                }
-                else
-                {
-                    glm::vec2 extrusion = points[p1].norm * halfLineWidth;
-                    detail::addPoint(innerPoints, points[p1].pos + extrusion);
-                    detail::addPoint(outerPoints, points[p1].pos - extrusion);
-                }
+namespace detail
+{
+    // Triangles of a stroke, built with indices relative to the subpath and
+    // copied into the mesh once its vertex count is known.
+    struct StrokeGeometry
+    {
+        std::vector<glm::vec2> vertices;
+        std::vector<uint32_t> indices;
+        std::vector<glm::vec2> arcPoints;
+        std::vector<uint32_t> meshVertices; // see appendTo()
+
+        inline void clear() {
+            vertices.clear();
+            indices.clear();
+        }
 
-            }
-        } else {
-            // Calculate normal vectors
-            points[0].norm = glm::vec2(points[0].dir.y, -points[0].dir.x); // first point
-            points.back().norm = glm::vec2(points.back().dir.y, -points.back().dir.x); // last point
-            for (size_t p0 = 0, p1 = 1; p0 < points.size()-2; p0++, p1++)
-            {
-                // rotate direction vector by 90degree CW
-                glm::vec2 dir0 = glm::vec2(points[p0].dir.y, -points[p0].dir.x);
-                glm::vec2 dir1 = glm::vec2(points[p1].dir.y, -points[p1].dir.x);
-                glm::vec2 norm = (dir0 + dir1) * 0.5f;
-                float dot = glm::dot(norm, norm);
-                if (dot > glm::epsilon<float>())
-                {
-                    norm *= glm::clamp(1.0f / dot, 0.0f, 1000.0f);
-                }
-                points[p1].norm = norm;
+        inline uint32_t add(glm::vec2 pos) {
+            vertices.push_back(pos);
+            return static_cast<uint32_t>(vertices.size() - 1);
+        }
 
-                float cross = glm::cross(points[p1].dir, points[p0].dir);
-                points[p1].properties.set(cross > 0.0f ? PointProperties::leftTurn : PointProperties::rightTurn);
+        inline void triangle(uint32_t a, uint32_t b, uint32_t c) {
+            indices.push_back(a);
+            indices.push_back(b);
+            indices.push_back(c);
+        }
 
-                float sharpnessLimit = glm::max(1.0f, glm::min(points[p0].length, points[p1].length) * (1.0f / halfLineWidth));
-                if (dot * sharpnessLimit * sharpnessLimit > 1.0f)
-                {
-                    points[p1].properties.set(PointProperties::sharp);
-                }
+        // band between the side vertices (plus, minus) of two consecutive points.
+        inline void quad(uint32_t plus0, uint32_t minus0, uint32_t plus1, uint32_t minus1) {
+            triangle(plus0, minus0, minus1);
+            triangle(plus0, minus1, plus1);
+        }
 
-                if (points[p1].properties.test(PointProperties::corner))
-                {
-                    if (lineJoin == LineJoin::bevel ||
-                        lineJoin == LineJoin::round ||
-                        dot * miterLimit * miterLimit < 1.0f)
-                    {
-                        points[p1].properties.set(PointProperties::bevel);
-                    }
-                }
+        // fan around 'hub' covering the arc of 'radius' around 'center' from
+        // the vertex 'from' to the vertex 'to', turning by 'sweep' radians.
+        void roundJoin(uint32_t hub, glm::vec2 center, float radius, uint32_t from, uint32_t to, float sweep, float tesselationTolerance) {
+            glm::vec2 start = vertices[from] - center;
+            float startAngle = glm::atan(start.y, start.x);
+
+            arcPoints.clear();
+            arc(arcPoints, center, radius, startAngle, startAngle + sweep, sweep < 0.0f, tesselationTolerance);
+
+            // the first and last arc points are 'from' and 'to'
+            uint32_t previous = from;
+            for (size_t i = 1; i + 1 < arcPoints.size(); ++i) {
+                uint32_t current = add(arcPoints[i]);
+                triangle(hub, previous, current);
+                previous = current;
             }
+            triangle(hub, previous, to);
+        }
 
-            // extrude our points
-            for (size_t p0 = points.size() - 1, p1 = 0; p1 < points.size(); p0 = p1++)
-            {
-                if (points[p1].properties.test(PointProperties::bevel) && points[p1].properties.test(PointProperties::leftTurn))
-                {
-                    if (lineJoin == LineJoin::round)
-                    {
-                        glm::vec2 v0 = points[p1].pos - glm::vec2(points[p1-1].dir.y, -points[p1-1].dir.x) * halfLineWidth;
-                        glm::vec2 v1 = points[p1].pos - points[p1].norm * halfLineWidth;
-                        glm::vec2 v2 = points[p1].pos - glm::vec2(points[p1].dir.y, -points[p1].dir.x) * halfLineWidth;
-                        detail::addPoint(outerPoints, v0);
-                        detail::arcTo(outerPoints, v0, v1, v2, halfLineWidth, tesselationTolerance);
-                    }
-                    else
-                    {
-                        glm::vec2 v0, v1;
-                        if (points[p1].properties.test(PointProperties::sharp))
-                        {
-                            // rotate direction vectors by 90degree CW
-                            glm::vec2 dir0 = glm::vec2(points[p0].dir.y, -points[p0].dir.x);
-                            glm::vec2 dir1 = glm::vec2(points[p1].dir.y, -points[p1].dir.x);
-
-                            v0 = points[p1].pos - dir0 * halfLineWidth;
-                            v1 = points[p1].pos - dir1 * halfLineWidth;
-                        }
-                        else
-                        {
-                            v0 = points[p1].pos - points[p0].norm * halfLineWidth;
-                            v1 = points[p1].pos - points[p1].norm * halfLineWidth;
-                        }
-
-                        detail::addPoint(outerPoints, v0);
-                        detail::addPoint(outerPoints, v1);
-                    }
+        // Local indices are 32 bits, the stroke of a long subpath can have more
+        // vertices than a batch holds. It is then split, triangle by triangle,
+        // and the vertices shared across a split are added again.
+        void appendTo(Mesh &mesh, const Color &color) {
+            if (vertices.size() <= Mesh::MAX_BATCH_VERTEX_COUNT) {
+                uint16_t offset = mesh.beginVertices(vertices.size());
+                for (const glm::vec2 &pos : vertices) {
+                    mesh.vertices.push_back({{pos.x, pos.y, 0.0f}, color});
                 }
-                else
-                {
-                    detail::addPoint(outerPoints, points[p1].pos - points[p1].norm * halfLineWidth);
+                for (uint32_t index : indices) {
+                    mesh.indices.push_back(static_cast<uint16_t>(offset + index));
                 }
+                return;
             }
 
-            // add the end cap
-            if (lineCap != LineCap::butt)
-            {
-                glm::vec2 dir = points.back().dir * halfLineWidth;
-                glm::vec2 ext = points.back().norm * halfLineWidth;
-
-                /*
-                    ...>>>>>>>>>(p0)---[+dir]-->(p1)
-                    ...-----------------         |
-                                        ---      |
-                                            -- [+ext]
-                                            -   |
-                                            -  V
-                                            - (p2)
-                                            -  |
-                                            -   |
-                                            -- [+ext]
-                                        ---      |
-                    ...-----------------         V
-                    ...<<<<<<<<<(p4)<--[-dir]---(p3)
-                    */
-
-                const glm::vec2 &p0 = outerPoints[outerPoints.size()-1];
-                glm::vec2 p1 = p0 + dir;
-                glm::vec2 p2 = p1 + ext;
-                glm::vec2 p3 = p2 + ext;
-                glm::vec2 p4 = p3 - dir;
-
-                if (lineCap == LineCap::round)
-                {
-                    // then arc 90 degrees from p1 to p3
-                    detail::arcTo(outerPoints, p0, p1, p2, halfLineWidth, tesselationTolerance);
-
-                    // then arc 90 degrees from p3 to p5
-                    detail::arcTo(outerPoints, p2, p3, p4, halfLineWidth, tesselationTolerance);
-                }
-                else // square
-                {
-                    detail::addPoint(outerPoints, p1);
-                    detail::addPoint(outerPoints, p2);
-                    detail::addPoint(outerPoints, p3);
-                    detail::addPoint(outerPoints, p4);
+            // mesh vertex of every local one, if it was added to the mesh.
+            meshVertices.assign(vertices.size(), UINT32_MAX);
+            for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+                size_t batchOffset = mesh.batches.empty() ? 0 : mesh.batches.back().vertexOffset;
+                size_t missing = 0;
+                for (size_t j = i; j < i + 3; ++j) {
+                    uint32_t vertex = meshVertices[indices[j]];
+                    missing += vertex == UINT32_MAX || vertex < batchOffset;
                 }
-            }
-
-            // extrude the 'other' side of our points in reverse.
-            for (size_t p0 = points.size(), p1 = points.size() - 1; p0 > 0; p0 = p1--)
-            {
-                if (points[p1].properties.test(PointProperties::bevel) && points[p1].properties.test(PointProperties::rightTurn))
-                {
-                    if (lineJoin == LineJoin::round)
-                    {
-                        glm::vec2 v0 = points[p1].pos + glm::vec2(points[p1].dir.y, -points[p1].dir.x) * halfLineWidth;
-                        glm::vec2 v1 = points[p1].pos + points[p1].norm * halfLineWidth;
-                        glm::vec2 v2 = points[p1].pos + glm::vec2(points[p1+1].dir.y, -points[p1+1].dir.x) * halfLineWidth;
-                        detail::addPoint(outerPoints, v0);
-                        detail::arcTo(outerPoints, v0, v1, v2, halfLineWidth, tesselationTolerance);
-                    }
-                    else
-                    {
-                        glm::vec2 v0, v1;
-                        if (points[p1].properties.test(PointProperties::sharp))
-                        {
-                            // rotate direction vectors by 90degree CW
-                            glm::vec2 dir0 = glm::vec2(points[p0].dir.y, -points[p0].dir.x);
-                            glm::vec2 dir1 = glm::vec2(points[p1].dir.y, -points[p1].dir.x);
-
-                            v0 = points[p1].pos + dir0 * halfLineWidth;
-                            v1 = points[p1].pos + dir1 * halfLineWidth;
-                        }
-                        else
-                        {
-                            v0 = points[p1].pos + points[p0].norm * halfLineWidth;
-                            v1 = points[p1].pos + points[p1].norm * halfLineWidth;
-                        }
-
-                        detail::addPoint(outerPoints, v1);
-                        detail::addPoint(outerPoints, v0);
+                mesh.beginVertices(missing);
+
+                batchOffset = mesh.batches.back().vertexOffset;
+                for (size_t j = i; j < i + 3; ++j) {
+                    uint32_t &vertex = meshVertices[indices[j]];
+                    if (vertex == UINT32_MAX || vertex < batchOffset) {
+                        vertex = static_cast<uint32_t>(mesh.vertices.size());
+                        const glm::vec2 &pos = vertices[indices[j]];
+                        mesh.vertices.push_back({{pos.x, pos.y, 0.0f}, color});
                     }
-                }
-                else
-                {
-                    detail::addPoint(outerPoints, points[p1].pos + points[p1].norm * halfLineWidth);
+                    mesh.indices.push_back(static_cast<uint16_t>(vertex - batchOffset));
                 }
             }
+        }
 
-            // add the front cap
-            if (lineCap != LineCap::butt)
-            {
-                glm::vec2 dir = points[0].dir * halfLineWidth;
-                glm::vec2 ext = points[0].norm * halfLineWidth;
-
-                /*
-                        (p3)---[+dir]-->(p4)>>>>>>>>>...
-                        ^         -----------------...
-                        |      ---
-                    [-ext]  --
-                        |   -
-                        |  -
-                        (p2) -
-                        ^  -
-                        |   -
-                    [-ext]  --
-                        |      ---
-                        |         -----------------...
-                        (p1)<--[-dir]---(p0)<<<<<<<<<...
-                    */
-
-                const glm::vec2 &p0 = outerPoints[outerPoints.size()-1];
-                glm::vec2 p1 = p0 - dir;
-                glm::vec2 p2 = p1 - ext;
-                glm::vec2 p3 = p2 - ext;
-                glm::vec2 p4 = p3 + dir;
-
-                if (lineCap == LineCap::round)
-                {
-                    // arc 90 degrees from p4 to p2
-                    detail::arcTo(outerPoints, p0, p1, p2, halfLineWidth, tesselationTolerance);
+        // geometry of the calling thread, its buffers only grow.
+        static inline StrokeGeometry &current() {
+            static thread_local StrokeGeometry geometry;
+            return geometry;
+        }
+    };
 
-                    // then arc 90 degrees from p2 to p0
-                    detail::arcTo(outerPoints, p2, p3, p4, halfLineWidth, tesselationTolerance);
+    // right hand side of a direction, 90 degrees clockwise.
+    inline glm::vec2 perpendicular(glm::vec2 dir) {
+        return glm::vec2(dir.y, -dir.x);
+    }
+}
 
-                    // remove duplicate p4 point since it is already
-                    // in outerPoints as the outerPoints[0]
-                    outerPoints.resize(outerPoints.size()-1);
-                }
-                else // square
-                {
-                    detail::addPoint(outerPoints, p1);
-                    detail::addPoint(outerPoints, p2);
-                    detail::addPoint(outerPoints, p3);
-                    // don't add p4 point since it is already
-                    // in outerPoints as the outerPoints[0]
-                }
-            }
-        }
+void Path2D::fillSubPaths(Mesh &mesh, bool closedOnly) {
+    // a lone convex contour can't overlap anything, the fill rule doesn't matter.
+    if (subPaths.size() == 1 && subPaths[0].convex && (subPaths[0].closed || !closedOnly)) {
+        VG_PROFILE_PHASE(meshAppend);
+        detail::appendTriangleFan(mesh, subPaths[0].points, fillStyle);
+        return;
     }
 
-    // Triangulate the fills (closed subpaths) if the color isn't transparent
-    // also skip if the strokeStyle and the fillStyle are the same for closed
-    // paths since we can optimized a bit by producing fewer triangles
-    if (fillStyle.a > 0 && strokeStyle != fillStyle) {
-        for (size_t id = 0; id < subPaths.size(); ++id) {
-            auto &subPath = subPaths[id];
+    // Everything else is swept at once, so the subpaths can cut holes into
+    // each other or overlap according to the fill rule.
+    VG_PROFILE_PHASE(triangulation);
 
-            if (!subPath.closed) continue; // skip. it's not an outline.
+    FillTessellator &tessellator = FillTessellator::current();
+    for (size_t id = 0; id < subPaths.size(); ++id) {
+        if (subPaths[id].closed || !closedOnly) {
+            tessellator.addContour(subPaths[id].points);
+        }
+    }
+    tessellator.tessellate(mesh, fillStyle, fillRule);
+}
 
-            auto &points = subPaths[id].innerPoints;
+void Path2D::expandStroke(Mesh &mesh) {
 
-            // we need at least 3 points to make a shape. Otherwise it is a line or a point or nothing at all :-) 
-            if (points.size() >= 3) {
+    VG_PROFILE_PHASE(strokeExpansion);
 
-                MPEPolyContext polyContext;
-                
-                // Request how much memory (in bytes) you should
-                // allocate for the library
-                size_t memoryRequired = MPE_PolyMemoryRequired(points.size());
+    // the outline is expanded after the transform. A non-uniform scale would
+    // vary the width along it, this keeps the width of the same area.
+    float halfLineWidth = lineWidth * transform.averageScale() * 0.5f;
 
-                // Allocate a memory block of size MemoryRequired
-                // IMPORTANT: The memory must be zero initialized
-                std::vector<uint8_t> mempool;
-                mempool.resize(memoryRequired, 0);
+    detail::StrokeGeometry &geometry = detail::StrokeGeometry::current();
 
-                // Initialize the poly context by passing the memory pointer,
-                // and max number of points from before
-                MPE_PolyInitContext(&polyContext, mempool.data(), points.size());
+    for (size_t id = 0; id < subPaths.size(); ++id) {
+        SubPath2D &subPath = subPaths[id];
+        auto &points = subPath.points;
 
-                MPEPolyPoint* polyPoints = MPE_PolyPushPointArray(&polyContext, points.size());
-                for(size_t j = 0; j < points.size(); ++j)
-                {
-                    glm::vec2 &point = points[j];
+        VG_PROFILE_COUNT(contourPoints, points.size());
 
-                    polyPoints[j].X = point.x;
-                    polyPoints[j].Y = point.y;
-                }
+        // a lonely point has no direction and can't be stroked.
+        if (points.size() < 2) continue;
 
-                MPE_PolyAddEdge(&polyContext);
+        // the subpaths are kept between calls, drop what depends on the line style.
+        for (ContourPoint &point : points) {
+            point.properties.reset(PointProperties::leftTurn);
+            point.properties.reset(PointProperties::rightTurn);
+            point.properties.reset(PointProperties::bevel);
+        }
 
-                MPE_PolyTriangulate(&polyContext);
+        // Calculate direction vectors
+        size_t segmentCount = subPath.closed ? points.size() : points.size() - 1;
+        for (size_t p0 = 0; p0 < segmentCount; ++p0) {
+            size_t p1 = p0 + 1 < points.size() ? p0 + 1 : 0;
+            glm::vec2 delta = points[p1].pos - points[p0].pos;
+            points[p0].length = glm::length(delta);
+            points[p0].dir = delta / points[p0].length;
+        }
+        if (!subPath.closed) {
+            // last point should have the same direction than its previous point.
+            points.back().dir = points[points.size()-2].dir;
+            points.back().norm = detail::perpendicular(points.back().dir);
+            points[0].norm = detail::perpendicular(points[0].dir);
+        }
 
-                uint32_t vertexCount = polyContext.PointPoolCount;
-                uint16_t indexCount = polyContext.TriangleCount*3;
+        // Calculate the miter vector and the kind of join at every corner
+        size_t firstJoin = subPath.closed ? 0 : 1;
+        size_t lastJoin = subPath.closed ? points.size() : points.size() - 1;
+        for (size_t p1 = firstJoin; p1 < lastJoin; ++p1) {
+            size_t p0 = p1 > 0 ? p1 - 1 : points.size() - 1;
 
-                uint16_t offset = mesh.vertices.size();
+            glm::vec2 norm = (detail::perpendicular(points[p0].dir) + detail::perpendicular(points[p1].dir)) * 0.5f;
+            float dot = glm::dot(norm, norm);
+            if (dot > glm::epsilon<float>())
+            {
+                norm *= glm::clamp(1.0f / dot, 0.0f, 1000.0f);
+            }
+            points[p1].norm = norm;
 
-                // populate the vertices
-                for (size_t vid = 0; vid < polyContext.PointPoolCount; ++vid) {
-                    MPEPolyPoint &point = polyContext.PointsPool[vid];
-                    mesh.vertices.push_back({{point.X, point.Y, 0.0f}, fillStyle});
-                }
+            float cross = glm::cross(points[p1].dir, points[p0].dir);
+            points[p1].properties.set(cross > 0.0f ? PointProperties::leftTurn : PointProperties::rightTurn);
 
-                // populate the indices
-                for (size_t tid = 0; tid < polyContext.TriangleCount; ++tid) {
-                    MPEPolyTriangle* triangle = polyContext.Triangles[tid];
-
-                    // get the array index by pointer address arithmetic.
-                    uint16_t p0 = static_cast<uint16_t>(triangle->Points[0] - polyContext.PointsPool);
-                    uint16_t p1 = static_cast<uint16_t>(triangle->Points[1] - polyContext.PointsPool);
-                    uint16_t p2 = static_cast<uint16_t>(triangle->Points[2] - polyContext.PointsPool);
-                    mesh.indices.push_back(offset+p2);
-                    mesh.indices.push_back(offset+p1);
-                    mesh.indices.push_back(offset+p0);
+            if (points[p1].properties.test(PointProperties::corner))
+            {
+                if (lineJoin == LineJoin::bevel || lineJoin == LineJoin::round ||
+                    dot * miterLimit * miterLimit < 1.0f)
+                {
+                    points[p1].properties.set(PointProperties::bevel);
                 }
             }
         }
-    }
 
+        geometry.clear();
 
+        // side vertices where the segment before a point ends (plusIn,
+        // minusIn) and where the one after it starts (plusOut, minusOut).
+        uint32_t plusIn = 0, minusIn = 0, plusOut = 0, minusOut = 0;
+        uint32_t firstPlusIn = 0, firstMinusIn = 0;
 
-    // Triangulate the lines (outterPoints that doesn't have inner points) and outlines (outter poitns that has inner points)
-    for (size_t id = 0; id < subPaths.size(); ++id) {
-        auto &subPath = subPaths[id];
-        auto &outerPoints = subPath.outerPoints;
-        auto &innerPoints = subPath.innerPoints;
-
-        uint32_t maxPointCount = static_cast<uint32_t>(outerPoints.size() + innerPoints.size());
-
-        MPEPolyContext polyContext;
-        
-        // Request how much memory (in bytes) you should
-        // allocate for the library
-        size_t memoryRequired = MPE_PolyMemoryRequired(maxPointCount);
-
-        // Allocate a memory block of size MemoryRequired
-        // IMPORTANT: The memory must be zero initialized
-        std::vector<uint8_t> mempool;
-        mempool.resize(memoryRequired, 0);
-
-        // Initialize the poly context by passing the memory pointer,
-        // and max number of points from before
-        MPE_PolyInitContext(&polyContext, mempool.data(), maxPointCount);
-
-        if (outerPoints.size() >= 3) {
-            // fill outer polyPoints buffer.
-            MPEPolyPoint* polyPoints = MPE_PolyPushPointArray(&polyContext, outerPoints.size());
-            for(size_t j = 0; j < outerPoints.size(); ++j) {
-                glm::vec2 &point = outerPoints[j];
-
-                polyPoints[j].X = point.x;
-                polyPoints[j].Y = point.y;
-            }
-            MPE_PolyAddEdge(&polyContext);
-        }
+        for (size_t p1 = 0; p1 < points.size(); ++p1) {
+            const ContourPoint &point = points[p1];
+            uint32_t previousPlusOut = plusOut;
+            uint32_t previousMinusOut = minusOut;
 
-        // Only cut out a hole if the fillStyle is different than the stroke style
-        if (fillStyle != strokeStyle && innerPoints.size() >= 3) {
-            // fill inner polyPoints buffer.
-            MPEPolyPoint* polyHoles = MPE_PolyPushPointArray(&polyContext, innerPoints.size());
-            for(size_t j = 0; j < innerPoints.size(); ++j)
-            {
-                glm::vec2 &point = innerPoints[j];
+            bool isEnd = !subPath.closed && (p1 == 0 || p1 == points.size() - 1);
+            if (isEnd || !point.properties.test(PointProperties::bevel)) {
+                // ends and miter joins share their vertices between both segments.
+                glm::vec2 extrusion = point.norm * halfLineWidth;
+                plusIn = plusOut = geometry.add(point.pos + extrusion);
+                minusIn = minusOut = geometry.add(point.pos - extrusion);
+            } else {
+                size_t p0 = p1 > 0 ? p1 - 1 : points.size() - 1;
+                glm::vec2 perp0 = detail::perpendicular(points[p0].dir) * halfLineWidth;
+                glm::vec2 perp1 = detail::perpendicular(points[p1].dir) * halfLineWidth;
+
+                // The join goes on the outside of the turn. Inside, both
+                // segments end on the miter point, unless it lands past the
+                // end of either of them: tan(turn/2) * halfLineWidth > length.
+                bool leftTurn = point.properties.test(PointProperties::leftTurn);
+                float side = leftTurn ? 1.0f : -1.0f;
+                float cosTurn = glm::dot(points[p0].dir, points[p1].dir);
+                float shortest = glm::min(points[p0].length, points[p1].length);
+                bool innerMiter = halfLineWidth * halfLineWidth * (1.0f - cosTurn) <= shortest * shortest * (1.0f + cosTurn);
+
+                uint32_t innerIn, innerOut, hub;
+                if (innerMiter) {
+                    innerIn = innerOut = hub = geometry.add(point.pos + point.norm * halfLineWidth * side);
+                } else {
+                    innerIn = geometry.add(point.pos + perp0 * side);
+                    innerOut = geometry.add(point.pos + perp1 * side);
+                    hub = geometry.add(point.pos);
+                }
+                uint32_t outerIn = geometry.add(point.pos - perp0 * side);
+                uint32_t outerOut = geometry.add(point.pos - perp1 * side);
+
+                if (lineJoin == LineJoin::round) {
+                    float sweep = glm::atan(glm::cross(perp0, perp1), glm::dot(perp0, perp1));
+                    geometry.roundJoin(hub, point.pos, halfLineWidth, outerIn, outerOut, sweep, tesselationTolerance);
+                } else {
+                    geometry.triangle(hub, outerIn, outerOut);
+                }
 
-                polyHoles[j].X = point.x;
-                polyHoles[j].Y = point.y;
+                plusIn = leftTurn ? innerIn : outerIn;
+                minusIn = leftTurn ? outerIn : innerIn;
+                plusOut = leftTurn ? innerOut : outerOut;
+                minusOut = leftTurn ? outerOut : innerOut;
             }
-            MPE_PolyAddHole(&polyContext);
-        }
 
+            if (p1 == 0) {
+                firstPlusIn = plusIn;
+                firstMinusIn = minusIn;
+            } else {
+                geometry.quad(previousPlusOut, previousMinusOut, plusIn, minusIn);
+            }
+        }
 
-        MPE_PolyTriangulate(&polyContext);
-
-        uint32_t vertexCount = polyContext.PointPoolCount;
-        uint16_t indexCount = polyContext.TriangleCount*3;
+        if (subPath.closed) {
+            geometry.quad(plusOut, minusOut, firstPlusIn, firstMinusIn);
+        } else if (lineCap == LineCap::square) {
+            glm::vec2 startExtension = points[0].dir * halfLineWidth;
+            uint32_t startPlus = geometry.add(geometry.vertices[firstPlusIn] - startExtension);
+            uint32_t startMinus = geometry.add(geometry.vertices[firstMinusIn] - startExtension);
+            geometry.quad(startPlus, startMinus, firstPlusIn, firstMinusIn);
+
+            glm::vec2 endExtension = points.back().dir * halfLineWidth;
+            uint32_t endPlus = geometry.add(geometry.vertices[plusOut] + endExtension);
+            uint32_t endMinus = geometry.add(geometry.vertices[minusOut] + endExtension);
+            geometry.quad(plusOut, minusOut, endPlus, endMinus);
+        } else if (lineCap == LineCap::round) {
+            // half turns from one side to the other, around the back of the
+            // first point and the front of the last one.
+            uint32_t startHub = geometry.add(points[0].pos);
+            geometry.roundJoin(startHub, points[0].pos, halfLineWidth, firstMinusIn, firstPlusIn, glm::pi<float>(), tesselationTolerance);
+
+            uint32_t endHub = geometry.add(points.back().pos);
+            geometry.roundJoin(endHub, points.back().pos, halfLineWidth, plusOut, minusOut, glm::pi<float>(), tesselationTolerance);
+        }
 
-        uint16_t offset = mesh.vertices.size();
+        VG_PROFILE_PHASE(meshAppend);
+        geometry.appendTo(mesh, strokeStyle);
+    }
+}
 
-        // populate the vertices
-        for (size_t vid = 0; vid < polyContext.PointPoolCount; ++vid) {
-            MPEPolyPoint &point = polyContext.PointsPool[vid];
-            mesh.vertices.push_back({{point.X, point.Y, 0.0f}, strokeStyle});
-        }
+void Path2D::stroke(Mesh &mesh) {
 
-        // populate the indices
-        for (size_t tid = 0; tid < polyContext.TriangleCount; ++tid) {
-            MPEPolyTriangle* triangle = polyContext.Triangles[tid];
+    flatten();
 
-            // get the array index by pointer address arithmetic.
-            uint16_t p0 = static_cast<uint16_t>(triangle->Points[0] - polyContext.PointsPool);
-            uint16_t p1 = static_cast<uint16_t>(triangle->Points[1] - polyContext.PointsPool);
-            uint16_t p2 = static_cast<uint16_t>(triangle->Points[2] - polyContext.PointsPool);
-            mesh.indices.push_back(offset+p2);
-            mesh.indices.push_back(offset+p1);
-            mesh.indices.push_back(offset+p0);
-        }
-        
+    // Closed subpaths are filled first if the fillStyle isn't transparent,
+    // then the stroke is drawn over them, like calling fill() and stroke() on
+    // the canvas.
+    if (fillStyle.a > 0) {
+        fillSubPaths(mesh, true);
     }
 
-    subPaths.clear();
+    expandStroke(mesh);
 }
 
 
@@ -1431,8 +2145,11 @@ SubPath2D &Path2D::getCurrentSubPath(bool addDefaultStartingPointIfCreated) {
     SubPath2D &currentSubPath = subPaths.back();
     if (currentSubPath.closed)
     {
+        // like on the canvas, the subpath after a closed one starts where the
+        // closed one started.
+        glm::vec2 start = currentSubPath.points.empty() ? glm::vec2() : currentSubPath.points[0].pos;
         SubPath2D &subPath = createSubPath();
-        if (addDefaultStartingPointIfCreated) detail::addPoint(subPath.points, glm::vec2(), PointProperties::corner);
+        if (addDefaultStartingPointIfCreated) detail::addPoint(subPath.points, start, PointProperties::corner);
         return subPath;
     }
 
@@ -4,7 +4,10 @@
 #include <array>
 #include <cfloat>
 #include <cstdint>
+#include <functional>
+#include <initializer_list>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <glm/vec2.hpp>
@@ -12,6 +15,8 @@
 
 #include "BitMask.h"
 #include "Color.h"
+#include "CurveBatch.h"
+#include "Transform2D.h"
 #include "VertexData.h"
 
 enum class LineCap : uint8_t
@@ -34,6 +39,43 @@ enum class FillRule : uint8_t
     evenOdd, //! The even-odd winding rule.
 };
 
+enum class CurveFlattener : uint8_t
+{
+    recursive = 0, //! Adaptive subdivision derived from AGG. Re-checks the flatness at every level.
+    forwardDifferencing, //! Segment count computed up front (Wang's formula), points evaluated by forward differencing.
+    batched, //! Curves collected until fill() or stroke(), then flattened together with SIMD (Wang's formula).
+};
+
+// Commands recorded by Path2D, followed by their parameters in
+// Path2D::commandParams.
+enum class PathCommand : uint8_t
+{
+    moveTo = 0, // x, y
+    lineTo, // x, y
+    bezierCurveTo, // cp1x, cp1y, cp2x, cp2y, x, y
+    quadraticCurveTo, // cpx, cpy, x, y
+    arc, // x, y, radius, startAngle, endAngle, anticlockwise
+    arcTo, // x1, y1, x2, y2, radius
+    ellipse, // x, y, radiusX, radiusY, rotation, startAngle, endAngle, anticlockwise
+    rect, // x, y, width, height
+    closePath,
+};
+
+// number of floats recorded in Path2D::commandParams for 'command'.
+inline uint32_t pathCommandParamCount(PathCommand command) {
+    switch (command) {
+        case PathCommand::moveTo: return 2;
+        case PathCommand::lineTo: return 2;
+        case PathCommand::bezierCurveTo: return 6;
+        case PathCommand::quadraticCurveTo: return 4;
+        case PathCommand::arc: return 6;
+        case PathCommand::arcTo: return 5;
+        case PathCommand::ellipse: return 8;
+        case PathCommand::rect: return 4;
+        default: return 0;
+    }
+}
+
 enum class Unit : uint8_t
 {
     px, 
@@ -51,7 +93,6 @@ enum class PointProperties : uint8_t
     leftTurn = 0x02,
     rightTurn = 0x04,
     bevel = 0x08,
-    sharp = 0x10,
 };
 
 struct ContourPoint {
@@ -65,16 +106,97 @@ struct ContourPoint {
 struct SubPath2D
 {
     std::vector<ContourPoint> points;
-    std::vector<glm::vec2> outerPoints;
-    std::vector<glm::vec2> innerPoints;
     bool closed = false; 
+    bool convex = false; // set when flattened. Convex contours are filled with a triangle fan.
+};
+
+struct BoundingBox {
+    glm::vec2 min = glm::vec2(FLT_MAX);
+    glm::vec2 max = glm::vec2(-FLT_MAX);
+
+    inline bool empty() const {
+        return min.x > max.x || min.y > max.y;
+    }
+
+    inline void add(glm::vec2 point) {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+};
+
+// Part of a Mesh drawn with a single call. Its indices are relative to its
+// first vertex, so they stay 16 bits however big the mesh gets.
+struct MeshBatch {
+    uint32_t vertexOffset = 0;
+    uint32_t indexOffset = 0;
+};
+
+// Read only Mesh whose arrays live somewhere else, e.g. in a mapped
+// BinaryScene file.
+struct MeshView {
+    const ColorVertex *vertices = nullptr;
+    size_t vertexCount = 0;
+    const uint16_t *indices = nullptr;
+    size_t indexCount = 0;
+    const MeshBatch *batches = nullptr;
+    size_t batchCount = 0;
+
+    // Whether the batches are in order and every index points inside of its
+    // batch, for meshes read from files.
+    bool isValid() const;
 };
 
 struct Mesh {
+    static constexpr size_t MAX_BATCH_VERTEX_COUNT = 65536;
+
     std::vector<ColorVertex> vertices;
     std::vector<uint16_t> indices;
+    std::vector<MeshBatch> batches;
+
+    // To call before adding 'vertexCount' vertices indexed together. Starts a
+    // new batch if they don't fit in the current one, and returns the index
+    // the first of them will have in the batch.
+    inline uint16_t beginVertices(size_t vertexCount) {
+        if (batches.empty() || vertices.size() + vertexCount - batches.back().vertexOffset > MAX_BATCH_VERTEX_COUNT) {
+            batches.push_back({static_cast<uint32_t>(vertices.size()), static_cast<uint32_t>(indices.size())});
+        }
+        return static_cast<uint16_t>(vertices.size() - batches.back().vertexOffset);
+    }
+
+    inline size_t batchVertexCount(size_t batch) const {
+        size_t end = batch + 1 < batches.size() ? batches[batch + 1].vertexOffset : vertices.size();
+        return end - batches[batch].vertexOffset;
+    }
+
+    inline size_t batchIndexCount(size_t batch) const {
+        size_t end = batch + 1 < batches.size() ? batches[batch + 1].indexOffset : indices.size();
+        return end - batches[batch].indexOffset;
+    }
+
+    inline void clear() {
+        vertices.clear();
+        indices.clear();
+        batches.clear();
+    }
+
+    inline MeshView view() const {
+        return {vertices.data(), vertices.size(), indices.data(), indices.size(), batches.data(), batches.size()};
+    }
+
+    // adds the vertices and triangles of 'mesh', batch by batch.
+    void append(const Mesh &mesh);
+    void append(const MeshView &mesh);
 };
 
+inline const char * curveFlattenerToString(CurveFlattener curveFlattener) {
+    switch (curveFlattener) {
+        case CurveFlattener::recursive: return "recursive";
+        case CurveFlattener::forwardDifferencing: return "forwardDifferencing";
+        case CurveFlattener::batched: return "batched";
+        default: return "?";
+    }
+}
+
 inline const char * unitToString(Unit unit) {
     switch (unit) {
         case Unit::px: return "px"; 
@@ -91,12 +213,25 @@ class Path2D {
 public:
 
     friend class VectorGraphic;
+    friend class BinaryScene;
+
+    // Flattener used by newly created paths, including the ones loaded from SVG.
+    static CurveFlattener defaultCurveFlattener;
 
     static std::vector<Path2D> fromSVGFile(const std::string &filePath, Unit unit, float dpi, float tesselationTolerance);
     static std::vector<Path2D> fromSVGBuffer(const std::string &buffer, Unit unit, float dpi, float tesselationTolerance);
+    // parses the null terminated 'buffer' in place, overwriting its content.
+    static std::vector<Path2D> fromSVGBuffer(char *buffer, Unit unit, float dpi, float tesselationTolerance);
+
+    // Streams large documents instead of loading them as a whole: every path is
+    // handed to 'sink' as soon as its element has been read, then destroyed.
+    // Memory is bounded by the group nesting depth and the largest element,
+    // not by the size of the document. Returns false if the file can't be
+    // opened or isn't well formed, the paths read until then have been sunk.
+    static bool streamSVGFile(const std::string &filePath, Unit unit, float dpi, float tesselationTolerance, const std::function<void(Path2D &path)> &sink);
 
     Path2D(float tesselationFactor) : tesselationTolerance(1.0f / tesselationFactor) {}
-    Path2D(float tesselationFactor, const std::string &svgData);
+    Path2D(float tesselationFactor, std::string_view svgData);
 
     void beginPath();
     void closePath();
@@ -109,6 +244,29 @@ public:
     void ellipse(float x, float y, float radiusX, float radiusY, float rotation, float startAngle, float endAngle, bool anticlockwise = false);
     void rect(float x, float y, float width, float height);
 
+    // The path is flattened again for the new tolerance on the next fill() or
+    // stroke(), from the recorded commands.
+    void setTesselationFactor(float tesselationFactor);
+
+    // Applied to every recorded command, control points included, when the
+    // path gets flattened, so curves are flattened for their size after the
+    // transform and no vertex has to be transformed afterwards. fillRect()
+    // and the stroke width follow it too.
+    void setTransform(const Transform2D &transform);
+    inline const Transform2D &getTransform() const {
+        return transform;
+    }
+
+    // Conservative bounds of the recorded commands: curves are bounded by
+    // their control points, arcs by their full circle or ellipse. Includes the
+    // transform.
+    BoundingBox getBounds() const;
+
+    // Hash of everything the meshes of fill() and stroke() depend on but the
+    // tesselation factor: commands, style, transform and curve flattener.
+    // Identical paths hash the same whatever document they come from.
+    uint64_t contentHash() const;
+
     void fill(Mesh &mesh);
     void fillRect(Mesh &mesh, float x, float y, float width, float height);
     void stroke(Mesh &mesh);
@@ -119,17 +277,38 @@ public:
     float miterLimit = 10.0f;
     LineJoin lineJoin = LineJoin::miter;
     LineCap lineCap = LineCap::butt;
+    FillRule fillRule = FillRule::nonZero;
+    CurveFlattener curveFlattener = defaultCurveFlattener;
 
 private:
 
+    void record(PathCommand command, std::initializer_list<float> params);
+    void flatten();
+    void closeSubPath();
     void calculateSegmentDirection();
+    void fillSubPaths(Mesh &mesh, bool closedOnly);
+    void expandStroke(Mesh &mesh);
+    void batchBezierTo(SubPath2D &subPath, float cp1x, float cp1y, float cp2x, float cp2y, float x, float y);
+    void flattenCurveBatch();
     
     SubPath2D &getCurrentSubPath(bool addDefaultStartingPointIfCreated = true);
     SubPath2D &createSubPath();
 
+    // what the path is made of, replayed by flatten().
+    std::vector<PathCommand> commands;
+    std::vector<float> commandParams;
+
+    // flattened geometry, reused until a command is added or the tolerance or
+    // the flattener changes.
     std::vector<SubPath2D> subPaths;
+    float flattenedTolerance = 0.0f;
+    CurveFlattener flattenedCurveFlattener = CurveFlattener::recursive;
+
+    // curves waiting to be flattened when curveFlattener is CurveFlattener::batched.
+    std::vector<PendingCurve> pendingCurves;
 
     float tesselationTolerance;
+    Transform2D transform;
 };
 
 
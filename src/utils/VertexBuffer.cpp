@@ -5,6 +5,7 @@
 template<>
 void VertexBuffer<TextureVertex>::renderUI() {
     if(ImGui::TreeNode("Vertex Buffer Object (TextureVertex)")) {
+        shadowCopiesInspected = true;
         if (ImGui::BeginTable(name.c_str(), 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY, ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing()*7)))
         {
             ImGui::TableSetupColumn("Pos X");
@@ -14,7 +15,7 @@ void VertexBuffer<TextureVertex>::renderUI() {
             ImGui::TableSetupColumn("Tex V");
             ImGui::TableHeadersRow();
 
-            float * values = &vertices[0].position.x;
+            float * values = reinterpret_cast<float *>(vertices.data());
             size_t count = vertices.size() * sizeof(TextureVertex) / sizeof(float);
             for (size_t i = 0; i < count; ++i)
             {
@@ -36,6 +37,7 @@ void VertexBuffer<TextureVertex>::renderUI() {
 template<>
 void VertexBuffer<ColorVertex>::renderUI() {
     if(ImGui::TreeNode("Vertex Buffer Object (ColorVertex)")) {
+        shadowCopiesInspected = true;
         if (ImGui::BeginTable(name.c_str(), 2, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg ))
         {
             ImGui::TableSetupColumn("Position");
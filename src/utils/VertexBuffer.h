@@ -4,6 +4,8 @@
 #include <glad/glad.h>
 #include <imgui.h>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "AbstractGPUObject.h"
 #include "ShaderProgram.h"
@@ -20,9 +22,13 @@ struct VertexBuffer : public AbstractGPUObject
     };
 
     GLuint handle = 0;
-    std::vector<Vertex> vertices;
+    size_t vertexCount = 0;
     Hint hint;
 
+    // CPU copy of the uploaded vertices, kept for the inspectors while
+    // keepShadowCopies is set. Empty otherwise.
+    std::vector<Vertex> vertices;
+
     inline VertexBuffer(const std::string &name) : AbstractGPUObject(name)
     {
         glGenBuffers(1, &handle);
@@ -34,7 +40,10 @@ struct VertexBuffer : public AbstractGPUObject
         handle = 0;
     }
 
-    inline void bind(const std::shared_ptr<ShaderProgram> &program)
+    // 'firstVertex' is the vertex the indices are relative to. Pointing the
+    // attributes there works everywhere, unlike glDrawElementsBaseVertex which
+    // WebGL and GLES 2 don't have.
+    inline void bind(const std::shared_ptr<ShaderProgram> &program, size_t firstVertex = 0)
     {
         glBindBuffer(GL_ARRAY_BUFFER, handle);
 
@@ -42,7 +51,7 @@ struct VertexBuffer : public AbstractGPUObject
         for(size_t i = 0; i < attributeLocations.size(); ++i)
         {
             const AttributeInfo &attribute = program->attribute(i);
-            size_t offset = program->attributeOffset(i);
+            size_t offset = program->attributeOffset(i) + firstVertex * program->vertexSize();
             glVertexAttribPointer(attributeLocations[i], attribute.count, attribute.type, attribute.action, program->vertexSize(),  reinterpret_cast<const GLvoid*>(offset));
         }
 
@@ -53,21 +62,59 @@ struct VertexBuffer : public AbstractGPUObject
         glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
+    // Uploads the 'count' vertices at 'data', which may be released or
+    // unmapped right after.
+    inline void upload(const Vertex *data, size_t count, Hint hint)
+    {
+        store(data, count, hint);
+        if (keepShadowCopies && isRegistered()) {
+            this->vertices.assign(data, data + count);
+        } else {
+            std::vector<Vertex>().swap(this->vertices);
+        }
+    }
+
     inline void upload(const std::vector<Vertex> &vertices, Hint hint)
     {
-        this->vertices = vertices;
-        this->hint = hint;
-        glBindBuffer(GL_ARRAY_BUFFER, handle);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertices.size(), vertices.data(), hint);
+        upload(vertices.data(), vertices.size(), hint);
+    }
+
+    // Takes 'vertices' over, as the shadow copy when one is kept.
+    inline void upload(std::vector<Vertex> &&vertices, Hint hint)
+    {
+        store(vertices.data(), vertices.size(), hint);
+        if (keepShadowCopies && isRegistered()) {
+            this->vertices = std::move(vertices);
+        } else {
+            std::vector<Vertex>().swap(this->vertices);
+            std::vector<Vertex>().swap(vertices);
+        }
     }
 
     inline virtual size_t getMemoryUsage() const override {
-        return sizeof(Vertex) * vertices.size();
+        return sizeof(Vertex) * vertexCount;
+    }
+
+    inline virtual size_t getShadowMemoryUsage() const override {
+        return sizeof(Vertex) * vertices.capacity();
+    }
+
+    inline virtual void releaseShadowCopy() override {
+        std::vector<Vertex>().swap(vertices);
     }
 
     inline virtual void renderUI() {
         ImGui::SeparatorText(name.c_str());
     }
+
+private:
+    inline void store(const Vertex *data, size_t count, Hint hint)
+    {
+        this->vertexCount = count;
+        this->hint = hint;
+        glBindBuffer(GL_ARRAY_BUFFER, handle);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * count, data, hint);
+    }
 };
 
 
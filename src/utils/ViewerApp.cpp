@@ -300,6 +300,23 @@ void ViewerApp::step()
         //resetRenderState();
     }
 
+    // The buffers copy what they upload only while something reads it back.
+    // Getting the copies means uploading everything again, e.g. the whole
+    // mesh of Sample02_VG_Trig, so it's only done once they are read: with
+    // the overlays, or a buffer expanded in the GPU Objects of the last frame.
+    bool keepShadowCopies = renderTriangles || renderVertices || AbstractGPUObject::shadowCopiesInspected;
+    AbstractGPUObject::shadowCopiesInspected = false;
+    if (AbstractGPUObject::keepShadowCopies != keepShadowCopies) {
+        AbstractGPUObject::keepShadowCopies = keepShadowCopies;
+        if (keepShadowCopies) {
+            m_samples[m_sampleCurrent]->resetRenderState();
+        } else {
+            for (auto &object : AbstractGPUObject::registry) {
+                object.second->releaseShadowCopy();
+            }
+        }
+    }
+
     if (renderSample) {
         m_samples[m_sampleCurrent]->render(shared_from_this(), mvp);
     }
@@ -364,7 +381,7 @@ void ViewerApp::step()
         }
         m_gpuMemStats.addPoint(frameTimeSecs, totalGPUMemUsage / 1024.0f); // from B to KB.
 
-        m_trigStats.addPoint(frameTimeSecs, m_samples[m_sampleCurrent]->getTriangles().size()); // from B to KB.
+        m_trigStats.addPoint(frameTimeSecs, m_samples[m_sampleCurrent]->getTriangleCount()); // from B to KB.
 
         statsTimeCounter = 0.0;
     } else {
@@ -438,6 +455,9 @@ void ViewerApp::renderUI(double frameTimeSecs)
                 ImGui::SeparatorText(it->first.c_str());
                 it->second->renderUI();   
                 ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f),"Estimated memory usage: %s", it->second->getPrintableMemoryUsage().c_str());
+                if (it->second->getShadowMemoryUsage() > 0) {
+                    ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f),"CPU shadow copy: %s", it->second->getPrintableShadowMemoryUsage().c_str());
+                }
                 it++;
             }
         }
@@ -0,0 +1,313 @@
+#include "XmlStreamReader.h"
+
+#include <cstring>
+
+static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+static inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static inline char *skipSpaces(char *cur, char *end) {
+    while (cur < end && isSpace(*cur)) ++cur;
+    return cur;
+}
+
+static inline char *skipName(char *cur, char *end) {
+    while (cur < end && !isSpace(*cur) && *cur != '/' && *cur != '>' && *cur != '=') ++cur;
+    return cur;
+}
+
+static char *encodeUtf8(char *out, uint32_t codePoint) {
+    if (codePoint < 0x80) {
+        *out++ = static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+        *out++ = static_cast<char>(0xC0 | (codePoint >> 6));
+        *out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        *out++ = static_cast<char>(0xE0 | (codePoint >> 12));
+        *out++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        *out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else {
+        *out++ = static_cast<char>(0xF0 | (codePoint >> 18));
+        *out++ = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        *out++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        *out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    return out;
+}
+
+// decodes the predefined and numeric character references of [begin, end) in
+// place and returns the new end. Unknown references are kept as is.
+static char *decodeEntities(char *begin, char *end) {
+    char *out = static_cast<char *>(memchr(begin, '&', end - begin));
+    if (!out) {
+        return end;
+    }
+
+    static const struct { const char *name; size_t size; char value; } entities[] = {
+        {"lt;", 3, '<'}, {"gt;", 3, '>'}, {"amp;", 4, '&'}, {"quot;", 5, '"'}, {"apos;", 5, '\''},
+    };
+
+    for (char *cur = out; cur < end;) {
+        if (*cur != '&') {
+            *out++ = *cur++;
+            continue;
+        }
+
+        char *reference = cur + 1;
+        bool decoded = false;
+        if (reference < end && *reference == '#') {
+            bool hex = reference + 1 < end && reference[1] == 'x';
+            char *digit = reference + (hex ? 2 : 1);
+            uint32_t codePoint = 0;
+            char *p = digit;
+            for (; p < end && codePoint <= 0x10FFFF; ++p) {
+                char c = *p;
+                if (c >= '0' && c <= '9') {
+                    codePoint = codePoint * (hex ? 16 : 10) + (c - '0');
+                } else if (hex && ((c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'))) {
+                    codePoint = codePoint * 16 + ((c | 0x20) - 'a' + 10);
+                } else {
+                    break;
+                }
+            }
+            // the UTF-8 encoding is never longer than the reference, "&#1;" included
+            if (p > digit && p < end && *p == ';' && codePoint > 0 && codePoint <= 0x10FFFF) {
+                out = encodeUtf8(out, codePoint);
+                cur = p + 1;
+                decoded = true;
+            }
+        } else {
+            for (const auto &entity : entities) {
+                if (static_cast<size_t>(end - reference) >= entity.size && memcmp(reference, entity.name, entity.size) == 0) {
+                    *out++ = entity.value;
+                    cur = reference + entity.size;
+                    decoded = true;
+                    break;
+                }
+            }
+        }
+
+        if (!decoded) {
+            *out++ = *cur++;
+        }
+    }
+    return out;
+}
+
+XmlStreamReader::~XmlStreamReader() {
+    close();
+}
+
+bool XmlStreamReader::open(const std::string &filePath) {
+    close();
+    m_file = fopen(filePath.c_str(), "rb");
+    if (!m_file) {
+        return false;
+    }
+    m_buffer.resize(CHUNK_SIZE);
+    return true;
+}
+
+void XmlStreamReader::close() {
+    if (m_file) {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+    m_buffer.clear();
+    m_buffer.shrink_to_fit();
+    m_attributes.clear();
+    m_position = 0;
+    m_size = 0;
+    m_name = nullptr;
+    m_pendingEndElement = false;
+    m_error = nullptr;
+}
+
+XmlStreamReader::Token XmlStreamReader::next() {
+    if (m_pendingEndElement) {
+        m_pendingEndElement = false;
+        return Token::endElement;
+    }
+    if (!m_file) {
+        return fail("No file opened");
+    }
+
+    for (;;) {
+        // text is skipped
+        char *text = m_buffer.data() + m_position;
+        char *markup = static_cast<char *>(memchr(text, '<', m_size - m_position));
+        if (!markup) {
+            m_position = m_size;
+            if (!readMore()) {
+                return ferror(m_file) ? fail("Read error") : Token::end;
+            }
+            continue;
+        }
+        m_position = markup - m_buffer.data();
+
+        size_t markupSize;
+        if (!findMarkupEnd(markupSize)) {
+            return fail(ferror(m_file) ? "Read error" : "Unexpected end of file");
+        }
+
+        char *begin = m_buffer.data() + m_position;
+        m_position += markupSize;
+
+        if (begin[1] != '!' && begin[1] != '?') {
+            return parseElement(begin, begin + markupSize - 1);
+        }
+    }
+}
+
+// makes sure 'count' bytes from m_position are in the buffer, unless the file
+// ends before.
+bool XmlStreamReader::ensure(size_t count) {
+    while (m_size - m_position < count) {
+        if (!readMore()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// moves the markup being parsed to the front of the buffer, grows the buffer
+// if the markup fills it, and reads the next chunk behind it.
+bool XmlStreamReader::readMore() {
+    if (m_position > 0) {
+        memmove(m_buffer.data(), m_buffer.data() + m_position, m_size - m_position);
+        m_size -= m_position;
+        m_position = 0;
+    }
+    if (m_size == m_buffer.size()) {
+        m_buffer.resize(m_buffer.size() * 2);
+    }
+
+    size_t count = fread(m_buffer.data() + m_size, 1, m_buffer.size() - m_size, m_file);
+    m_size += count;
+    return count > 0;
+}
+
+// size of the markup starting with the '<' at m_position, up to and including
+// its closing '>'. The scan resumes where it stopped when more has to be read,
+// so tags spanning many chunks are only scanned once.
+bool XmlStreamReader::findMarkupEnd(size_t &markupSize) {
+    // "<![CDATA[" is the longest opening to tell apart
+    ensure(9);
+
+    const char *begin = m_buffer.data() + m_position;
+    size_t available = m_size - m_position;
+    const char *terminator = nullptr; // comments, CDATA sections and processing instructions end with a sequence
+    size_t openingSize = 1;
+    if (available >= 4 && memcmp(begin, "<!--", 4) == 0) {
+        terminator = "-->";
+        openingSize = 4;
+    } else if (available >= 9 && memcmp(begin, "<![CDATA[", 9) == 0) {
+        terminator = "]]>";
+        openingSize = 9;
+    } else if (available >= 2 && begin[1] == '?') {
+        terminator = "?>";
+        openingSize = 2;
+    }
+    size_t terminatorSize = terminator ? strlen(terminator) : 0;
+
+    char quote = 0;
+    int bracketDepth = 0; // DOCTYPE internal subset
+    size_t offset = openingSize;
+    for (;;) {
+        const char *markup = m_buffer.data() + m_position;
+        for (; m_position + offset < m_size; ++offset) {
+            char c = markup[offset];
+            if (terminator) {
+                if (c == '>' && offset + 1 >= openingSize + terminatorSize &&
+                    memcmp(markup + offset + 1 - terminatorSize, terminator, terminatorSize) == 0) {
+                    markupSize = offset + 1;
+                    return true;
+                }
+            } else if (quote) {
+                if (c == quote) quote = 0;
+            } else if (c == '"' || c == '\'') {
+                quote = c;
+            } else if (c == '[') {
+                ++bracketDepth;
+            } else if (c == ']') {
+                --bracketDepth;
+            } else if (c == '>' && bracketDepth <= 0) {
+                markupSize = offset + 1;
+                return true;
+            }
+        }
+        if (!readMore()) {
+            return false;
+        }
+    }
+}
+
+// parses the tag [begin, end), 'end' being its '>'.
+XmlStreamReader::Token XmlStreamReader::parseElement(char *begin, char *end) {
+    m_attributes.clear();
+
+    if (begin[1] == '/') {
+        char *name = begin + 2;
+        char *nameEnd = skipName(name, end);
+        if (nameEnd == name) {
+            return fail("Missing element name");
+        }
+        *nameEnd = '\0';
+        m_name = name;
+        return Token::endElement;
+    }
+
+    char *name = begin + 1;
+    char *cur = skipName(name, end);
+    if (cur == name) {
+        return fail("Missing element name");
+    }
+    char *nameEnd = cur;
+
+    bool emptyElement = false;
+    for (;;) {
+        cur = skipSpaces(cur, end);
+        if (cur == end) {
+            break;
+        }
+        if (*cur == '/') {
+            emptyElement = true;
+            break;
+        }
+
+        char *attributeName = cur;
+        cur = skipName(cur, end);
+        char *attributeNameEnd = cur;
+        cur = skipSpaces(cur, end);
+        if (attributeNameEnd == attributeName || cur == end || *cur != '=') {
+            return fail("Expected an attribute");
+        }
+        cur = skipSpaces(cur + 1, end);
+        if (cur == end || (*cur != '"' && *cur != '\'')) {
+            return fail("Expected a quoted attribute value");
+        }
+        char quote = *cur++;
+        char *value = cur;
+        char *valueEnd = static_cast<char *>(memchr(value, quote, end - value));
+        if (!valueEnd) {
+            return fail("Unterminated attribute value");
+        }
+        cur = valueEnd + 1;
+
+        *attributeNameEnd = '\0';
+        *decodeEntities(value, valueEnd) = '\0';
+        m_attributes.push_back({attributeName, value});
+    }
+
+    *nameEnd = '\0';
+    m_name = name;
+    m_pendingEndElement = emptyElement;
+    return Token::startElement;
+}
+
+XmlStreamReader::Token XmlStreamReader::fail(const char *error) {
+    m_error = error;
+    return Token::error;
+}
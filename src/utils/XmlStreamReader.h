@@ -0,0 +1,78 @@
+#ifndef XML_STREAM_READER_H
+#define XML_STREAM_READER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Pull parser for XML files too large to be loaded as a whole. The file is
+// read a chunk at a time and only the element being parsed is kept in memory,
+// so the buffer grows to the size of the largest tag, not of the document.
+// Text, comments, CDATA sections, processing instructions and the DOCTYPE are
+// skipped. Names and values are null terminated in place and entities in
+// values are decoded, like rapidxml does.
+class XmlStreamReader
+{
+public:
+    enum class Token : uint8_t
+    {
+        startElement,
+        endElement, // also reported right after the startElement of an empty element (<path/>)
+        end,
+        error
+    };
+
+    struct Attribute
+    {
+        const char *name;
+        const char *value;
+    };
+
+    XmlStreamReader() = default;
+    ~XmlStreamReader();
+
+    XmlStreamReader(const XmlStreamReader &) = delete;
+    XmlStreamReader &operator=(const XmlStreamReader &) = delete;
+
+    bool open(const std::string &filePath);
+    void close();
+
+    Token next();
+
+    // of the last startElement or endElement. Only valid until the next call
+    // to next().
+    inline const char *name() const {
+        return m_name;
+    }
+
+    // of the last startElement.
+    inline const std::vector<Attribute> &attributes() const {
+        return m_attributes;
+    }
+
+    // reason of the last Token::error.
+    inline const char *error() const {
+        return m_error;
+    }
+
+private:
+    bool ensure(size_t count);
+    bool readMore();
+    bool findMarkupEnd(size_t &markupSize);
+    Token parseElement(char *begin, char *end);
+    Token fail(const char *error);
+
+    FILE *m_file = nullptr;
+
+    std::vector<char> m_buffer;
+    size_t m_position = 0; // start of the markup being parsed
+    size_t m_size = 0; // bytes read into m_buffer
+
+    const char *m_name = nullptr;
+    std::vector<Attribute> m_attributes;
+    bool m_pendingEndElement = false;
+    const char *m_error = nullptr;
+};
+
+#endif // XML_STREAM_READER_H
@@ -0,0 +1,121 @@
+// Host side asset baker.
+//
+// Converts an SVG file to a BinaryScene with its meshes tessellated ahead of
+// time, so the viewer maps them instead of parsing and triangulating, e.g.
+//
+//   vgbake --factors 25,100,400 assets/android.svg assets/android.vgs
+//
+// The factors are the ones LODMeshCache asks for (baseTesselationFactor times
+// a power of 4), the meshes of the others are still tessellated at runtime.
+// So are the meshes of every factor while the viewer flattens the curves with
+// another flattener than --flattener (Path2D::defaultCurveFlattener unless
+// given). The scene is written to a temporary file first, an interrupted bake
+// leaves the previous one in place. See bake_vector_asset() in
+// cmake/bake_vector_asset.cmake.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "BinaryScene.h"
+#include "SampleScenes.h"
+#include "VectorGraphic.h"
+
+static std::vector<std::string> split(const std::string &value, char separator) {
+    std::vector<std::string> result;
+    size_t start = 0;
+    while (start <= value.size()) {
+        size_t end = value.find(separator, start);
+        if (end == std::string::npos) {
+            end = value.size();
+        }
+        if (end > start) {
+            result.push_back(value.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+    return result;
+}
+
+static void printUsage(const char *executable) {
+    fprintf(stderr,
+            "usage: %s [--factors F1,F2,...] [--flattener C] INPUT.svg OUTPUT.vgs\n"
+            "flatteners: recursive, forwardDifferencing, batched\n",
+            executable);
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<float> tesselationFactors = {100.0f};
+    std::vector<std::string> filePaths;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--factors") == 0 && hasValue) {
+            tesselationFactors.clear();
+            for (const std::string &factor : split(argv[++i], ',')) {
+                float tesselationFactor = static_cast<float>(atof(factor.c_str()));
+                if (tesselationFactor <= 0.0f) {
+                    printUsage(argv[0]);
+                    return 1;
+                }
+                tesselationFactors.push_back(tesselationFactor);
+            }
+        } else if (strcmp(argv[i], "--flattener") == 0 && hasValue) {
+            std::string name = argv[++i];
+            if (name == curveFlattenerToString(CurveFlattener::recursive)) {
+                Path2D::defaultCurveFlattener = CurveFlattener::recursive;
+            } else if (name == curveFlattenerToString(CurveFlattener::forwardDifferencing)) {
+                Path2D::defaultCurveFlattener = CurveFlattener::forwardDifferencing;
+            } else if (name == curveFlattenerToString(CurveFlattener::batched)) {
+                Path2D::defaultCurveFlattener = CurveFlattener::batched;
+            } else {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (argv[i][0] != '-') {
+            filePaths.push_back(argv[i]);
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (filePaths.size() != 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    const std::string &svgFilePath = filePaths[0];
+    const std::string &sceneFilePath = filePaths[1];
+
+    if (!writeBinaryScene(svgFilePath, sceneFilePath, tesselationFactors)) {
+        fprintf(stderr, "Could not bake %s to %s\n", svgFilePath.c_str(), sceneFilePath.c_str());
+        return 1;
+    }
+
+    // read back with the checks of the viewer, so a bad scene fails the build
+    // rather than the viewer falling back to the SVG file.
+    BinaryScene scene;
+    if (!scene.open(sceneFilePath)) {
+        fprintf(stderr, "Could not read %s back: %s\n", sceneFilePath.c_str(), scene.error());
+        remove(sceneFilePath.c_str());
+        return 1;
+    }
+
+    printf("%s: %zu paths", sceneFilePath.c_str(), scene.pathCount());
+    for (size_t lod = 0; lod < scene.lodCount(); ++lod) {
+        size_t vertexCount = 0;
+        size_t indexCount = 0;
+        for (size_t i = 0; i < scene.pathCount(); ++i) {
+            MeshView mesh = scene.pathMesh(lod, i);
+            vertexCount += mesh.vertexCount;
+            indexCount += mesh.indexCount;
+        }
+        printf(", factor %g: %zu vertices %zu indices", scene.lodTesselationFactor(lod), vertexCount, indexCount);
+    }
+    printf("\n");
+
+    return 0;
+}